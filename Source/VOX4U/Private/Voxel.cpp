@@ -8,7 +8,10 @@ UVoxel::UVoxel()
 	: Size(ForceInit)
 	, CellBounds(FVector::ZeroVector, FVector(100.f, 100.f, 100.f), 100.f)
 	, bXYCenter(true)
+	, bPaletteInstancing(false)
 	, Meshes()
+	, MeshColors()
+	, PaletteMaterial(nullptr)
 	, Voxels() {}
 
 #if WITH_EDITORONLY_DATA
@@ -2,6 +2,7 @@
 // Edited by Muppetsg2 2025
 
 #include "VoxelComponent.h"
+#include <Async/ParallelFor.h>
 #include <Components/InstancedStaticMeshComponent.h>
 #include <Containers/ArrayBuilder.h>
 #include <Engine/StaticMesh.h>
@@ -10,17 +11,27 @@
 UVoxelComponent::UVoxelComponent()
 	: CellBounds(FVector::ZeroVector, FVector(100.f, 100.f, 100.f), 100.f)
 	, bHideUnbeheld(true)
+	, ChunkSize(32)
 	, Meshes()
-	, Cells()
+	, CellEdits()
+	, RemovedCells()
+	, Cells_DEPRECATED()
 	, Voxel(nullptr)
-	, InstancedStaticMeshComponents() {}
+	, InstancedStaticMeshComponents()
+	, ProxyMeshes()
+	, ChunkInstances()
+	, InstanceCells()
+	, CellInstances()
+	, DirtyCells()
+	, EditDepth(0) {}
 
 #if WITH_EDITOR
 void UVoxelComponent::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
 {
 	static const FName NAME_HideUnbeheld = FName(TEXT("bHideUnbeheld"));
-	static const FName NAME_Meshes = FName(TEXT("Meshes"));
 	static const FName NAME_Voxel = FName(TEXT("Voxel"));
+	static const FName NAME_ChunkSize = FName(TEXT("ChunkSize"));
+	static const FName NAME_Meshes = FName(TEXT("Meshes"));
 	if (PropertyChangedEvent.Property)
 	{
 		if (PropertyChangedEvent.Property->GetFName() == NAME_HideUnbeheld)
@@ -28,22 +39,16 @@ void UVoxelComponent::PostEditChangeProperty(FPropertyChangedEvent& PropertyChan
 			ClearVoxel();
 			AddVoxel();
 		}
-		else if (PropertyChangedEvent.Property->GetFName() == NAME_Meshes)
+		else if (PropertyChangedEvent.Property->GetFName() == NAME_Voxel)
 		{
-			FBoxSphereBounds MeshesBounds(ForceInit);
-			for (int32 i = 0; i < Meshes.Num(); ++i)
-			{
-				InstancedStaticMeshComponents[i]->SetStaticMesh(Meshes[i]);
-				if (Meshes[i])
-				{
-					MeshesBounds = MeshesBounds + Meshes[i]->GetBounds();
-				}
-			}
-			CellBounds = MeshesBounds;
+			Meshes.Empty();
+			CellEdits.Empty();
+			RemovedCells.Empty();
+			InitVoxel();
 		}
-		else if (PropertyChangedEvent.Property->GetFName() == NAME_Voxel)
+		else if (PropertyChangedEvent.Property->GetFName() == NAME_ChunkSize || PropertyChangedEvent.Property->GetFName() == NAME_Meshes)
 		{
-			SetVoxel(Voxel, true);
+			InitVoxel();
 		}
 	}
 	Super::PostEditChangeProperty(PropertyChangedEvent);
@@ -54,6 +59,12 @@ void UVoxelComponent::SetVoxel(class UVoxel* InVoxel, bool bForce /*= false*/)
 {
 	if (Voxel != InVoxel || bForce)
 	{
+		if (Voxel != InVoxel)
+		{
+			Meshes.Empty();
+			CellEdits.Empty();
+			RemovedCells.Empty();
+		}
 		Voxel = InVoxel;
 		InitVoxel();
 	}
@@ -64,46 +75,624 @@ const UVoxel* UVoxelComponent::GetVoxel() const
 	return Voxel;
 }
 
+/**
+ * Components saved before cells became copy-on-write hold a full copy of the asset cells
+ * The copy is reduced to the cells differing from the asset, so edits made with it are kept
+ */
+void UVoxelComponent::PostLoad()
+{
+	Super::PostLoad();
+	if (0 < Cells_DEPRECATED.Num() && Voxel)
+	{
+		Voxel->ConditionalPostLoad();
+		for (const auto& Cell : Cells_DEPRECATED)
+		{
+			const uint8* Value = Voxel->Voxels.Find(Cell.Key);
+			if (!Value || *Value != Cell.Value)
+			{
+				CellEdits.Add(Cell.Key, Cell.Value);
+			}
+		}
+		for (const auto& Cell : Voxel->Voxels)
+		{
+			if (!Cells_DEPRECATED.Contains(Cell.Key))
+			{
+				RemovedCells.Add(Cell.Key);
+			}
+		}
+	}
+	Cells_DEPRECATED.Empty();
+}
+
+/**
+ * Instanced static meshes are transient, so they are created again for loaded or duplicated components
+ * Instance maps are rebuilt with them whenever they do not describe the current instanced static meshes
+ */
+void UVoxelComponent::OnRegister()
+{
+	Super::OnRegister();
+	if (Voxel && (InstancedStaticMeshComponents.Num() == 0 || InstanceCells.Num() != InstancedStaticMeshComponents.Num() || ProxyMeshes.Num() != InstancedStaticMeshComponents.Num()))
+	{
+		InitVoxel();
+	}
+	for (UInstancedStaticMeshComponent* Proxy : InstancedStaticMeshComponents)
+	{
+		if (Proxy && !Proxy->IsRegistered())
+		{
+			Proxy->RegisterComponent();
+		}
+	}
+}
+
+/**
+ * Cell of asset with the edits of this component applied
+ * Every value is a valid cell, mesh index zero included, so presence is returned separately
+ * @param InVector Cell position
+ * @param OutValue Out cell value, untouched when empty
+ * @return bool Cell is occupied
+ */
+bool UVoxelComponent::TryGetCell(const FIntVector& InVector, uint8& OutValue) const
+{
+	if (const uint8* Edit = CellEdits.Find(InVector))
+	{
+		OutValue = *Edit;
+		return true;
+	}
+	const uint8* Value = Voxel && !(0 < RemovedCells.Num() && RemovedCells.Contains(InVector)) ? Voxel->Voxels.Find(InVector) : nullptr;
+	if (Value)
+	{
+		OutValue = *Value;
+		return true;
+	}
+	return false;
+}
+
+uint8 UVoxelComponent::GetCellValue(const FIntVector& InVector) const
+{
+	uint8 Value = 0;
+	TryGetCell(InVector, Value);
+	return Value;
+}
+
 void UVoxelComponent::InitVoxel()
 {
 	CellBounds = FBoxSphereBounds(FVector::ZeroVector, FVector(100.f, 100.f, 100.f), 100.f);
-	Meshes.Empty();
-	Cells.Empty();
+	for (UInstancedStaticMeshComponent* Proxy : InstancedStaticMeshComponents)
+	{
+		if (Proxy)
+		{
+			Proxy->DestroyComponent();
+		}
+	}
 	InstancedStaticMeshComponents.Empty();
+	ProxyMeshes.Empty();
+	ChunkInstances.Empty();
+	InstanceCells.Empty();
+	CellInstances.Empty();
+	DirtyCells.Empty();
 	if (Voxel)
 	{
 		CellBounds = Voxel->CellBounds;
-		Meshes = Voxel->Meshes;
-		Cells = Voxel->Voxels;
-		for (int32 i = 0; i < Meshes.Num(); ++i)
+		// Meshes edited on this component are kept, new or empty entries take the asset mesh
+		Meshes.SetNum(Voxel->Meshes.Num());
+		for (int32 MeshIndex = 0; MeshIndex < Meshes.Num(); ++MeshIndex)
 		{
-			UInstancedStaticMeshComponent* Proxy = NewObject<UInstancedStaticMeshComponent>(this, NAME_None, RF_Transactional);
-			Proxy->SetStaticMesh(Meshes[i]);
-			Proxy->AttachToComponent(GetOwner()->GetRootComponent(), FAttachmentTransformRules::KeepRelativeTransform, NAME_None);
-			InstancedStaticMeshComponents.Add(Proxy);
+			if (!Meshes[MeshIndex])
+			{
+				Meshes[MeshIndex] = Voxel->Meshes[MeshIndex];
+			}
 		}
 		AddVoxel();
 	}
 }
 
+/**
+ * Add an instance for every shown voxel
+ * Occupancy is packed into a bitset once, or a hashed set when cells are scattered, neighbour masks and transforms are computed in parallel
+ * and each instanced static mesh of a chunk receives its instances in one batch
+ */
 void UVoxelComponent::AddVoxel()
 {
-	FVector Offset = Voxel->bXYCenter ? FVector((float)Voxel->Size.X, (float)Voxel->Size.Y, 0.f) * CellBounds.BoxExtent : FVector::ZeroVector;
-	for (auto& voxel : Voxel->Voxels)
+	if (!Voxel)
+	{
+		return;
+	}
+
+	// Asset cells shared by every component, overridden by the edits of this one
+	TArray<FIntVector> Positions;
+	TArray<uint8> Values;
+	Positions.Reserve(Voxel->Voxels.Num() + CellEdits.Num());
+	Values.Reserve(Voxel->Voxels.Num() + CellEdits.Num());
+	const bool bEdited = 0 < CellEdits.Num() || 0 < RemovedCells.Num();
+	for (const auto& Cell : Voxel->Voxels)
+	{
+		if (!bEdited || !(CellEdits.Contains(Cell.Key) || RemovedCells.Contains(Cell.Key)))
+		{
+			Positions.Add(Cell.Key);
+			Values.Add(Cell.Value);
+		}
+	}
+	for (const auto& Edit : CellEdits)
+	{
+		Positions.Add(Edit.Key);
+		Values.Add(Edit.Value);
+	}
+	const int32 NumCells = Positions.Num();
+	if (NumCells == 0)
 	{
-		if (bHideUnbeheld && IsUnbeheldVolume(voxel.Key)) continue;
-		FVector Translation = FVector(voxel.Key) * CellBounds.BoxExtent * 2 - CellBounds.Origin + CellBounds.BoxExtent - Offset;
-		FTransform Transform(FQuat::Identity, Translation, FVector(1.f));
-		InstancedStaticMeshComponents[voxel.Value]->AddInstance(Transform);
+		return;
 	}
+
+	FIntVector Min = Positions[0];
+	FIntVector Max = Min;
+	for (const FIntVector& Position : Positions)
+	{
+		Min = FIntVector(FMath::Min(Min.X, Position.X), FMath::Min(Min.Y, Position.Y), FMath::Min(Min.Z, Position.Z));
+		Max = FIntVector(FMath::Max(Max.X, Position.X), FMath::Max(Max.Y, Position.Y), FMath::Max(Max.Z, Position.Z));
+	}
+
+	// One cell of padding on each side, so neighbours of every cell are inside the bitset
+	// Edits may lie far from the asset, a bitset much larger than the cells falls back to a hashed set
+	const FIntVector Origin = Min - FIntVector(1, 1, 1);
+	const int64 ExtentX = (int64)Max.X - Min.X + 3;
+	const int64 ExtentY = (int64)Max.Y - Min.Y + 3;
+	const int64 ExtentZ = (int64)Max.Z - Min.Z + 3;
+	const int64 NumBits = ExtentX * ExtentY * ExtentZ;
+	const bool bDense = ExtentX < MAX_int32 && ExtentY < MAX_int32 && ExtentZ < MAX_int32
+		&& NumBits <= FMath::Max<int64>((int64)NumCells * 64, 1 << 20) && NumBits < MAX_int32;
+	const FIntVector Extent = bDense ? FIntVector((int32)ExtentX, (int32)ExtentY, (int32)ExtentZ) : FIntVector::ZeroValue;
+	auto GetIndex = [&Origin, &Extent](const FIntVector& Position)
+	{
+		const FIntVector Local = Position - Origin;
+		return (Local.Z * Extent.Y + Local.Y) * Extent.X + Local.X;
+	};
+	TBitArray<> Occupancy;
+	TSet<FIntVector> SparseOccupancy;
+	if (bDense)
+	{
+		Occupancy.Init(false, (int32)NumBits);
+		for (const FIntVector& Position : Positions)
+		{
+			Occupancy[GetIndex(Position)] = true;
+		}
+	}
+	else
+	{
+		SparseOccupancy.Append(Positions);
+	}
+
+	// Up, Down, Forward, Backward, Right, Left
+	const FIntVector Neighbours[6] = { FIntVector(0, 0, 1), FIntVector(0, 0, -1), FIntVector(1, 0, 0), FIntVector(-1, 0, 0), FIntVector(0, 1, 0), FIntVector(0, -1, 0) };
+	const int32 NeighbourOffsets[6] = { Extent.X * Extent.Y, -Extent.X * Extent.Y, 1, -1, Extent.X, -Extent.X };
+	const int32 NumMeshes = Meshes.Num();
+	TArray<int32> MeshIndices;
+	TArray<FTransform> Transforms;
+	MeshIndices.SetNumUninitialized(NumCells);
+	Transforms.SetNumUninitialized(NumCells);
+	ParallelFor(NumCells, [&](int32 Index)
+	{
+		uint8 NeighbourMask = 0;
+		if (bDense)
+		{
+			const int32 CellIndex = GetIndex(Positions[Index]);
+			for (int32 Direction = 0; Direction < 6; ++Direction)
+			{
+				NeighbourMask |= Occupancy[CellIndex + NeighbourOffsets[Direction]] ? 1 << Direction : 0;
+			}
+		}
+		else
+		{
+			for (int32 Direction = 0; Direction < 6; ++Direction)
+			{
+				NeighbourMask |= SparseOccupancy.Contains(Positions[Index] + Neighbours[Direction]) ? 1 << Direction : 0;
+			}
+		}
+		const int32 MeshIndex = Voxel->GetMeshIndex(Values[Index]);
+		const bool bHidden = (bHideUnbeheld && NeighbourMask == 0x3F) || CellInstances.Contains(Positions[Index]);
+		MeshIndices[Index] = !bHidden && MeshIndex < NumMeshes ? MeshIndex : INDEX_NONE;
+		Transforms[Index] = FTransform(FQuat::Identity, GetCellTranslation(Positions[Index]), FVector(1.f));
+	});
+
+	// Instanced static meshes are created on the calling thread, one per chunk and mesh showing a cell
+	TArray<int32> ProxyIndices;
+	TArray<FIntVector> ChunkCoords;
+	ProxyIndices.SetNumUninitialized(NumCells);
+	ChunkCoords.SetNumUninitialized(NumCells);
+	for (int32 Index = 0; Index < NumCells; ++Index)
+	{
+		ChunkCoords[Index] = GetChunkCoord(Positions[Index]);
+		ProxyIndices[Index] = MeshIndices[Index] != INDEX_NONE ? GetProxy(ChunkCoords[Index], MeshIndices[Index]) : INDEX_NONE;
+	}
+
+	const int32 NumProxies = InstancedStaticMeshComponents.Num();
+	TArray<int32> ProxyCounts;
+	ProxyCounts.SetNumZeroed(NumProxies);
+	for (const int32 ProxyIndex : ProxyIndices)
+	{
+		if (ProxyIndex != INDEX_NONE)
+		{
+			++ProxyCounts[ProxyIndex];
+		}
+	}
+	TArray<TArray<FTransform>> ProxyTransforms;
+	TArray<TArray<float>> ProxyCustomData;
+	ProxyTransforms.SetNum(NumProxies);
+	ProxyCustomData.SetNum(NumProxies);
+	CellInstances.Reserve(CellInstances.Num() + NumCells);
+	for (int32 ProxyIndex = 0; ProxyIndex < NumProxies; ++ProxyIndex)
+	{
+		ProxyTransforms[ProxyIndex].Reserve(ProxyCounts[ProxyIndex]);
+		InstanceCells[ProxyIndex].Reserve(InstanceCells[ProxyIndex].Num() + ProxyCounts[ProxyIndex]);
+		ProxyCustomData[ProxyIndex].Reserve(Voxel->bPaletteInstancing ? ProxyCounts[ProxyIndex] : 0);
+	}
+	for (int32 Index = 0; Index < NumCells; ++Index)
+	{
+		const int32 ProxyIndex = ProxyIndices[Index];
+		if (ProxyIndex != INDEX_NONE)
+		{
+			CellInstances.Add(Positions[Index], FIntPoint(ProxyIndex, InstanceCells[ProxyIndex].Add(Positions[Index])));
+			ProxyTransforms[ProxyIndex].Add(Transforms[Index]);
+			ChunkInstances[ChunkCoords[Index]].Bounds += GetCellBox(Positions[Index]);
+			if (Voxel->bPaletteInstancing)
+			{
+				ProxyCustomData[ProxyIndex].Add((float)Values[Index]);
+			}
+		}
+	}
+
+	for (int32 ProxyIndex = 0; ProxyIndex < NumProxies; ++ProxyIndex)
+	{
+		if (ProxyTransforms[ProxyIndex].Num() == 0)
+		{
+			continue;
+		}
+		UInstancedStaticMeshComponent* Proxy = InstancedStaticMeshComponents[ProxyIndex];
+		const int32 FirstInstance = Proxy->GetInstanceCount();
+		Proxy->AddInstances(ProxyTransforms[ProxyIndex], false);
+		if (Voxel->bPaletteInstancing)
+		{
+			const TArray<float>& CustomData = ProxyCustomData[ProxyIndex];
+			for (int32 Index = 0; Index < CustomData.Num(); ++Index)
+			{
+				Proxy->SetCustomDataValue(FirstInstance + Index, 0, CustomData[Index], false);
+			}
+			Proxy->MarkRenderStateDirty();
+		}
+	}
+	UpdateBounds();
 }
 
 void UVoxelComponent::ClearVoxel()
 {
-	for (int32 i = 0; i < Meshes.Num(); ++i)
+	for (UInstancedStaticMeshComponent* Proxy : InstancedStaticMeshComponents)
+	{
+		Proxy->ClearInstances();
+	}
+	for (TArray<FIntVector>& ProxyCells : InstanceCells)
+	{
+		ProxyCells.Reset();
+	}
+	for (auto& Chunk : ChunkInstances)
+	{
+		Chunk.Value.Bounds = FBox(ForceInit);
+	}
+	CellInstances.Reset();
+	UpdateBounds();
+}
+
+void UVoxelComponent::BeginEdit()
+{
+	++EditDepth;
+}
+
+void UVoxelComponent::EndEdit()
+{
+	if (!ensureMsgf(0 < EditDepth, TEXT("EndEdit without BeginEdit")))
 	{
-		InstancedStaticMeshComponents[i]->ClearInstances();
+		return;
 	}
+	if (--EditDepth == 0)
+	{
+		FlushEdits();
+	}
+}
+
+void UVoxelComponent::SetCell(const FIntVector& InVector, uint8 Value)
+{
+	BeginEdit();
+	EditCell(InVector, Value);
+	EndEdit();
+}
+
+void UVoxelComponent::RemoveCell(const FIntVector& InVector)
+{
+	BeginEdit();
+	EditCell(InVector, TOptional<uint8>());
+	EndEdit();
+}
+
+void UVoxelComponent::FillBox(const FIntVector& InMin, const FIntVector& InMax, uint8 Value)
+{
+	BeginEdit();
+	for (int32 Z = FMath::Min(InMin.Z, InMax.Z); Z <= FMath::Max(InMin.Z, InMax.Z); ++Z)
+	{
+		for (int32 Y = FMath::Min(InMin.Y, InMax.Y); Y <= FMath::Max(InMin.Y, InMax.Y); ++Y)
+		{
+			for (int32 X = FMath::Min(InMin.X, InMax.X); X <= FMath::Max(InMin.X, InMax.X); ++X)
+			{
+				EditCell(FIntVector(X, Y, Z), Value);
+			}
+		}
+	}
+	EndEdit();
+}
+
+void UVoxelComponent::CarveSphere(const FIntVector& InCenter, float Radius)
+{
+	BeginEdit();
+	const int32 Extent = FMath::FloorToInt32(FMath::Max(Radius, 0.f));
+	const float RadiusSquared = Radius * Radius;
+	for (int32 Z = -Extent; Z <= Extent; ++Z)
+	{
+		for (int32 Y = -Extent; Y <= Extent; ++Y)
+		{
+			for (int32 X = -Extent; X <= Extent; ++X)
+			{
+				if ((float)(X * X + Y * Y + Z * Z) <= RadiusSquared)
+				{
+					EditCell(InCenter + FIntVector(X, Y, Z), TOptional<uint8>());
+				}
+			}
+		}
+	}
+	EndEdit();
+}
+
+/**
+ * Write cell and mark it dirty
+ * Copy on write, only cells differing from the asset are stored: set values in CellEdits, removed asset cells in RemovedCells
+ * @param InVector Cell position
+ * @param Value New cell value, unset removes the cell
+ */
+void UVoxelComponent::EditCell(const FIntVector& InVector, TOptional<uint8> Value)
+{
+	uint8 Current = 0;
+	const bool bOccupied = TryGetCell(InVector, Current);
+	if (Value.IsSet() ? bOccupied && Current == Value.GetValue() : !bOccupied)
+	{
+		return;
+	}
+	const uint8* AssetValue = Voxel ? Voxel->Voxels.Find(InVector) : nullptr;
+	CellEdits.Remove(InVector);
+	RemovedCells.Remove(InVector);
+	if (Value.IsSet() && !(AssetValue && *AssetValue == Value.GetValue()))
+	{
+		CellEdits.Add(InVector, Value.GetValue());
+	}
+	else if (!Value.IsSet() && AssetValue)
+	{
+		RemovedCells.Add(InVector);
+	}
+	DirtyCells.Add(InVector);
+}
+
+/**
+ * Update instances of dirty cells and of their neighbours
+ * Freed instances of an instanced static mesh are reused for its new cells through UpdateInstanceTransform,
+ * the rest are removed or added in one call per instanced static mesh. Only chunks holding affected cells are touched
+ */
+void UVoxelComponent::FlushEdits()
+{
+	if (!Voxel || DirtyCells.Num() == 0)
+	{
+		DirtyCells.Reset();
+		return;
+	}
+
+	static const FIntVector Directions[6] = {
+		FIntVector(+0, +0, +1), FIntVector(+0, +0, -1),
+		FIntVector(+1, +0, +0), FIntVector(-1, +0, +0),
+		FIntVector(+0, +1, +0), FIntVector(+0, -1, +0) };
+	TSet<FIntVector> AffectedCells;
+	AffectedCells.Reserve(DirtyCells.Num() * (bHideUnbeheld ? 7 : 1));
+	for (const FIntVector& Cell : DirtyCells)
+	{
+		AffectedCells.Add(Cell);
+		for (int32 Direction = 0; bHideUnbeheld && Direction < 6; ++Direction)
+		{
+			AffectedCells.Add(Cell + Directions[Direction]);
+		}
+	}
+	DirtyCells.Reset();
+
+	// Instanced static mesh that should show each affected cell, created before instances move
+	const int32 NumMeshes = Meshes.Num();
+	TArray<TPair<FIntVector, int32>> Targets;
+	Targets.Reserve(AffectedCells.Num());
+	for (const FIntVector& Cell : AffectedCells)
+	{
+		uint8 Value = 0;
+		const int32 MeshIndex = TryGetCell(Cell, Value) ? Voxel->GetMeshIndex(Value) : INDEX_NONE;
+		const bool bShown = MeshIndex != INDEX_NONE && MeshIndex < NumMeshes && !(bHideUnbeheld && IsUnbeheldVolume(Cell));
+		Targets.Emplace(Cell, bShown ? GetProxy(GetChunkCoord(Cell), MeshIndex) : INDEX_NONE);
+	}
+
+	const int32 NumProxies = InstancedStaticMeshComponents.Num();
+	TArray<TArray<int32>> FreedSlots;
+	TArray<TArray<FIntVector>> NewCells;
+	TBitArray<> DirtyProxies(false, NumProxies);
+	TSet<FIntVector> DirtyChunks;
+	FreedSlots.SetNum(NumProxies);
+	NewCells.SetNum(NumProxies);
+	for (const TPair<FIntVector, int32>& Target : Targets)
+	{
+		const FIntVector& Cell = Target.Key;
+		const int32 ProxyIndex = Target.Value;
+		const FIntPoint* Instance = CellInstances.Find(Cell);
+		if (Instance && Instance->X == ProxyIndex)
+		{
+			if (Voxel->bPaletteInstancing)
+			{
+				InstancedStaticMeshComponents[ProxyIndex]->SetCustomDataValue(Instance->Y, 0, (float)GetCellValue(Cell), false);
+				DirtyProxies[ProxyIndex] = true;
+			}
+			continue;
+		}
+		if (Instance)
+		{
+			FreedSlots[Instance->X].Add(Instance->Y);
+			DirtyProxies[Instance->X] = true;
+			CellInstances.Remove(Cell);
+		}
+		if (ProxyIndex != INDEX_NONE)
+		{
+			NewCells[ProxyIndex].Add(Cell);
+			DirtyProxies[ProxyIndex] = true;
+		}
+		DirtyChunks.Add(GetChunkCoord(Cell));
+	}
+
+	for (TConstSetBitIterator<> It(DirtyProxies); It; ++It)
+	{
+		const int32 ProxyIndex = It.GetIndex();
+		UInstancedStaticMeshComponent* Proxy = InstancedStaticMeshComponents[ProxyIndex];
+		TArray<FIntVector>& ProxyCells = InstanceCells[ProxyIndex];
+		TArray<int32>& Slots = FreedSlots[ProxyIndex];
+		const TArray<FIntVector>& Added = NewCells[ProxyIndex];
+		Slots.Sort();
+
+		const int32 NumReused = FMath::Min(Slots.Num(), Added.Num());
+		for (int32 Index = 0; Index < NumReused; ++Index)
+		{
+			const int32 Slot = Slots[Index];
+			const FIntVector& Cell = Added[Index];
+			Proxy->UpdateInstanceTransform(Slot, FTransform(FQuat::Identity, GetCellTranslation(Cell), FVector(1.f)), false, false, true);
+			if (Voxel->bPaletteInstancing)
+			{
+				Proxy->SetCustomDataValue(Slot, 0, (float)GetCellValue(Cell), false);
+			}
+			ProxyCells[Slot] = Cell;
+			CellInstances.Add(Cell, FIntPoint(ProxyIndex, Slot));
+		}
+
+		// Remove from the back, each freed slot receives the current last instance
+		TArray<int32> Removed;
+		Removed.Reserve(Slots.Num() - NumReused);
+		for (int32 Index = Slots.Num() - 1; NumReused <= Index; --Index)
+		{
+			const int32 Slot = Slots[Index];
+			const int32 Last = ProxyCells.Num() - 1;
+			if (Slot != Last)
+			{
+				ProxyCells[Slot] = ProxyCells[Last];
+				CellInstances[ProxyCells[Slot]].Y = Slot;
+			}
+			ProxyCells.Pop(EAllowShrinking::No);
+			Removed.Add(Slot);
+		}
+		if (0 < Removed.Num())
+		{
+			Proxy->RemoveInstances(Removed, true);
+		}
+
+		if (NumReused < Added.Num())
+		{
+			const int32 FirstInstance = ProxyCells.Num();
+			TArray<FTransform> Transforms;
+			Transforms.Reserve(Added.Num() - NumReused);
+			for (int32 Index = NumReused; Index < Added.Num(); ++Index)
+			{
+				Transforms.Add(FTransform(FQuat::Identity, GetCellTranslation(Added[Index]), FVector(1.f)));
+				CellInstances.Add(Added[Index], FIntPoint(ProxyIndex, ProxyCells.Add(Added[Index])));
+			}
+			Proxy->AddInstances(Transforms, false);
+			for (int32 Index = 0; Voxel->bPaletteInstancing && Index < Transforms.Num(); ++Index)
+			{
+				Proxy->SetCustomDataValue(FirstInstance + Index, 0, (float)GetCellValue(Added[NumReused + Index]), false);
+			}
+		}
+		Proxy->MarkRenderStateDirty();
+	}
+
+	for (const FIntVector& ChunkCoord : DirtyChunks)
+	{
+		UpdateChunkBounds(ChunkCoord);
+	}
+	UpdateBounds();
+}
+
+/**
+ * Instanced static mesh of chunk showing cells of mesh, created and registered on first use
+ * @param ChunkCoord Chunk coordinate
+ * @param MeshIndex Mesh index of cell value
+ * @return int32 Index in instanced static mesh components
+ */
+int32 UVoxelComponent::GetProxy(const FIntVector& ChunkCoord, int32 MeshIndex)
+{
+	FVoxelChunkInstances& Chunk = ChunkInstances.FindOrAdd(ChunkCoord);
+	if (Chunk.Proxies.Num() == 0)
+	{
+		Chunk.Proxies.Init(INDEX_NONE, Meshes.Num());
+	}
+	if (Chunk.Proxies[MeshIndex] == INDEX_NONE)
+	{
+		// Transient, instances are rebuilt from the shared asset instead of being saved with every placed actor
+		UInstancedStaticMeshComponent* Proxy = NewObject<UInstancedStaticMeshComponent>(this, NAME_None, RF_Transient);
+		Proxy->SetStaticMesh(Meshes[MeshIndex]);
+		Proxy->NumCustomDataFloats = Voxel->bPaletteInstancing ? 1 : 0;
+		// Removal moves the last instance into the freed slot, instance maps mirror it
+		Proxy->SetRemoveSwap();
+		// Proxies are created lazily, owners without a root component get them attached to this component
+		USceneComponent* Parent = GetOwner() && GetOwner()->GetRootComponent() ? GetOwner()->GetRootComponent() : this;
+		Proxy->AttachToComponent(Parent, FAttachmentTransformRules::KeepRelativeTransform, NAME_None);
+		if (IsRegistered())
+		{
+			Proxy->RegisterComponent();
+		}
+		Chunk.Proxies[MeshIndex] = InstancedStaticMeshComponents.Add(Proxy);
+		ProxyMeshes.Add(MeshIndex);
+		InstanceCells.AddDefaulted();
+	}
+	return Chunk.Proxies[MeshIndex];
+}
+
+/**
+ * Recompute cached bounds of chunk from its shown cells
+ * @param ChunkCoord Chunk coordinate
+ */
+void UVoxelComponent::UpdateChunkBounds(const FIntVector& ChunkCoord)
+{
+	FVoxelChunkInstances* Chunk = ChunkInstances.Find(ChunkCoord);
+	if (!Chunk)
+	{
+		return;
+	}
+	Chunk->Bounds = FBox(ForceInit);
+	for (const int32 ProxyIndex : Chunk->Proxies)
+	{
+		if (ProxyIndex != INDEX_NONE)
+		{
+			for (const FIntVector& Cell : InstanceCells[ProxyIndex])
+			{
+				Chunk->Bounds += GetCellBox(Cell);
+			}
+		}
+	}
+}
+
+FIntVector UVoxelComponent::GetChunkCoord(const FIntVector& InVector) const
+{
+	const int32 Size = FMath::Max(ChunkSize, 1);
+	auto FloorDiv = [Size](int32 Value)
+	{
+		return 0 <= Value ? Value / Size : (Value + 1) / Size - 1;
+	};
+	return FIntVector(FloorDiv(InVector.X), FloorDiv(InVector.Y), FloorDiv(InVector.Z));
+}
+
+FBox UVoxelComponent::GetCellBox(const FIntVector& InVector) const
+{
+	return FBox::BuildAABB(GetCellTranslation(InVector) + CellBounds.Origin, CellBounds.BoxExtent);
 }
 
 bool UVoxelComponent::IsUnbeheldVolume(const FIntVector& InVector) const
@@ -118,7 +707,8 @@ bool UVoxelComponent::IsUnbeheldVolume(const FIntVector& InVector) const
 	int count = 0;
 	for (int i = 0; i < Direction.Num(); ++i)
 	{
-		if (Voxel->Voxels.Contains(InVector + Direction[i]))
+		uint8 Value;
+		if (TryGetCell(InVector + Direction[i], Value))
 		{
 			++count;
 		}
@@ -128,10 +718,9 @@ bool UVoxelComponent::IsUnbeheldVolume(const FIntVector& InVector) const
 
 bool UVoxelComponent::GetVoxelTransform(const FIntVector& InVector, FTransform& OutVoxelTransform, bool bWorldSpace /*= false*/) const
 {
-	if (!Cells.Contains(InVector)) return false;
-	FVector Offset = Voxel->bXYCenter ? FVector((float)Voxel->Size.X, (float)Voxel->Size.Y, 0.f) * CellBounds.BoxExtent : FVector::ZeroVector;
-	FVector Translation = FVector(InVector) * CellBounds.BoxExtent * 2 - CellBounds.Origin + CellBounds.BoxExtent - Offset;
-	OutVoxelTransform = FTransform(FQuat::Identity, Translation, FVector(1.f));
+	uint8 Value;
+	if (!TryGetCell(InVector, Value)) return false;
+	OutVoxelTransform = FTransform(FQuat::Identity, GetCellTranslation(InVector), FVector(1.f));
 	if (bWorldSpace)
 	{
 		OutVoxelTransform = OutVoxelTransform * GetComponentToWorld();
@@ -139,14 +728,20 @@ bool UVoxelComponent::GetVoxelTransform(const FIntVector& InVector, FTransform&
 	return true;
 }
 
+FVector UVoxelComponent::GetCellTranslation(const FIntVector& InVector) const
+{
+	const FVector Offset = Voxel->bXYCenter ? FVector((float)Voxel->Size.X, (float)Voxel->Size.Y, 0.f) * CellBounds.BoxExtent : FVector::ZeroVector;
+	return FVector(InVector) * CellBounds.BoxExtent * 2 - CellBounds.Origin + CellBounds.BoxExtent - Offset;
+}
+
 FBoxSphereBounds UVoxelComponent::CalcBounds(const FTransform& LocalToWorld) const
 {
-	FBoxSphereBounds ComponentBounds = FBoxSphereBounds(ForceInit);
-	for (auto* InstancedStaticMeshComponent : InstancedStaticMeshComponents)
+	FBox ComponentBox(ForceInit);
+	for (const auto& Chunk : ChunkInstances)
 	{
-		ComponentBounds = ComponentBounds + InstancedStaticMeshComponent->CalcBounds(LocalToWorld);
+		ComponentBox += Chunk.Value.Bounds;
 	}
-	return ComponentBounds;
+	return ComponentBox.IsValid ? FBoxSphereBounds(ComponentBox.TransformBy(LocalToWorld)) : FBoxSphereBounds(LocalToWorld.GetLocation(), FVector::ZeroVector, 0.f);
 }
 
 const TArray<UInstancedStaticMeshComponent*>& UVoxelComponent::GetInstancedStaticMeshComponent() const
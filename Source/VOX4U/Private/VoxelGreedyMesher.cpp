@@ -0,0 +1,144 @@
+// Copyright (c) 2025 Muppetsg2
+// Licensed under the MIT License.
+
+#include "VoxelGreedyMesher.h"
+
+/**
+ * Mesh one chunk with greedy rectangle merging
+ * Border cells hide faces of chunk cells but own no faces, so faces between chunks are meshed exactly once
+ * @param OutMesh Out mesh section
+ * @param Cells Palette colors of chunk with one cell border, x-fastest. Zero is empty
+ * @param ChunkSize Edge length of chunk without border
+ * @param Origin Component space position of chunk lattice origin
+ * @param CellSize Component space size of one cell
+ */
+void FVoxelGreedyMesher::CreateChunkMesh(FVoxelChunkMesh& OutMesh, const TArray<uint8>& Cells, int32 ChunkSize, const FVector& Origin, const FVector& CellSize)
+{
+	const int32 Extent = ChunkSize + 2;
+	check(Cells.Num() == Extent * Extent * Extent);
+	auto GetCell = [&Cells, Extent](const FIntVector& Local)
+	{
+		return Cells[((Local.Z + 1) * Extent + Local.Y + 1) * Extent + Local.X + 1];
+	};
+
+	TArray<int32> Mask;
+	for (int32 Dimension = 0; Dimension < 3; ++Dimension)
+	{
+		const FIntVector Axis = FIntVector(Dimension, (Dimension + 1) % 3, (Dimension + 2) % 3);
+		FIntVector Back = FIntVector::ZeroValue;
+		Back[Axis.Z] = -1;
+		for (int32 Depth = 0; Depth <= ChunkSize; ++Depth)
+		{
+			// Positive values face the front cell, negative values the back cell
+			Mask.Init(0, ChunkSize * ChunkSize);
+			bool bAnyFace = false;
+			for (int32 Y = 0; Y < ChunkSize; ++Y)
+			{
+				for (int32 X = 0; X < ChunkSize; ++X)
+				{
+					FIntVector Local;
+					Local[Axis.X] = X;
+					Local[Axis.Y] = Y;
+					Local[Axis.Z] = Depth;
+					const uint8 FrontValue = GetCell(Local);
+					const uint8 BackValue = GetCell(Local + Back);
+					const int32 Value = FrontValue && !BackValue && Depth < ChunkSize ? FrontValue
+						: BackValue && !FrontValue && 0 < Depth ? -(int32)BackValue : 0;
+					Mask[Y * ChunkSize + X] = Value;
+					bAnyFace |= Value != 0;
+				}
+			}
+			if (!bAnyFace)
+			{
+				continue;
+			}
+
+			for (int32 Y = 0; Y < ChunkSize; ++Y)
+			{
+				for (int32 X = 0; X < ChunkSize;)
+				{
+					const int32 Value = Mask[Y * ChunkSize + X];
+					if (Value == 0)
+					{
+						++X;
+						continue;
+					}
+
+					int32 Right = X + 1;
+					while (Right < ChunkSize && Mask[Y * ChunkSize + Right] == Value)
+					{
+						++Right;
+					}
+
+					int32 Top = Y + 1;
+					for (; Top < ChunkSize; ++Top)
+					{
+						bool bRowMatch = true;
+						for (int32 i = X; i < Right && bRowMatch; ++i)
+						{
+							bRowMatch = Mask[Top * ChunkSize + i] == Value;
+						}
+						if (!bRowMatch)
+						{
+							break;
+						}
+					}
+
+					for (int32 j = Y; j < Top; ++j)
+					{
+						for (int32 i = X; i < Right; ++i)
+						{
+							Mask[j * ChunkSize + i] = 0;
+						}
+					}
+
+					WriteQuad(OutMesh, Axis, Value, X, Y, Right, Top, Depth, Origin, CellSize);
+					X = Right;
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Write rectangle as two triangles with four vertices of its own, so normals stay flat
+ * Palette color is passed in UV0 the same way static mesh import addresses the palette texture
+ * @param OutMesh Out mesh section
+ * @param Axis Component index of scan faces
+ * @param Value Signed face palette color
+ */
+void FVoxelGreedyMesher::WriteQuad(FVoxelChunkMesh& OutMesh, const FIntVector& Axis, int32 Value, int32 Left, int32 Bottom, int32 Right, int32 Top, int32 Depth, const FVector& Origin, const FVector& CellSize)
+{
+	const auto ToPosition = [&](int32 X, int32 Y) -> FVector
+	{
+		FVector Lattice;
+		Lattice[Axis.X] = X;
+		Lattice[Axis.Y] = Y;
+		Lattice[Axis.Z] = Depth;
+		return Origin + Lattice * CellSize;
+	};
+
+	FVector Normal = FVector::ZeroVector;
+	Normal[Axis.Z] = 0 < Value ? -1.0 : 1.0;
+	FVector Tangent = FVector::ZeroVector;
+	Tangent[Axis.X] = 1.0;
+	const FVector2D TexCoord(((double)(0 < Value ? Value : -Value) + 0.5) / 256.0, 0.5);
+
+	const int32 First = OutMesh.Vertices.Num();
+	OutMesh.Vertices.Add(ToPosition(Left, Bottom));
+	OutMesh.Vertices.Add(ToPosition(Right, Bottom));
+	OutMesh.Vertices.Add(ToPosition(Left, Top));
+	OutMesh.Vertices.Add(ToPosition(Right, Top));
+	for (int32 Corner = 0; Corner < 4; ++Corner)
+	{
+		OutMesh.Normals.Add(Normal);
+		OutMesh.UV0.Add(TexCoord);
+		OutMesh.Tangents.Add(FProcMeshTangent(Tangent, false));
+	}
+
+	const int32 Indices[2][6] = { { 1, 0, 2, 1, 2, 3 }, { 0, 1, 2, 2, 1, 3 } };
+	for (const int32 Index : Indices[0 < Value ? 1 : 0])
+	{
+		OutMesh.Triangles.Add(First + Index);
+	}
+}
@@ -0,0 +1,36 @@
+// Copyright (c) 2025 Muppetsg2
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <CoreMinimal.h>
+#include <ProceduralMeshComponent.h>
+
+/**
+ * @struct FVoxelChunkMesh
+ * Mesh section of one chunk in component space
+ */
+struct FVoxelChunkMesh
+{
+	TArray<FVector> Vertices;
+	TArray<int32> Triangles;
+	TArray<FVector> Normals;
+	TArray<FVector2D> UV0;
+	TArray<FProcMeshTangent> Tangents;
+};
+
+/**
+ * Greedy quad mesher of runtime chunks, same faces and winding as the editor greedy mesher
+ * @see https://0fps.net/2012/06/30/meshing-in-a-minecraft-game/
+ */
+class FVoxelGreedyMesher
+{
+public:
+
+	/** Mesh owned cells of chunk volume padded by one cell of its neighbours */
+	static void CreateChunkMesh(FVoxelChunkMesh& OutMesh, const TArray<uint8>& Cells, int32 ChunkSize, const FVector& Origin, const FVector& CellSize);
+
+private:
+
+	static void WriteQuad(FVoxelChunkMesh& OutMesh, const FIntVector& Axis, int32 Value, int32 Left, int32 Bottom, int32 Right, int32 Top, int32 Depth, const FVector& Origin, const FVector& CellSize);
+};
@@ -0,0 +1,402 @@
+// Copyright (c) 2025 Muppetsg2
+// Licensed under the MIT License.
+
+#include "VoxelMeshComponent.h"
+#include <Async/Async.h>
+#include <Materials/MaterialInterface.h>
+#include <UObject/ObjectSaveContext.h>
+#include "Voxel.h"
+#include "VoxelGreedyMesher.h"
+
+/**
+ * @struct FVoxelMeshTask
+ * Background meshing of one chunk, owned by the component and the running task
+ */
+struct FVoxelMeshTask
+{
+	TFuture<void> Future;
+	FVoxelChunkMesh Mesh;
+};
+
+UVoxelMeshComponent::UVoxelMeshComponent(const FObjectInitializer& ObjectInitializer /*= FObjectInitializer::Get()*/)
+	: Super(ObjectInitializer)
+	, Voxel(nullptr)
+	, ChunkSize(32)
+	, Material(nullptr)
+	, bChunkCollision(true)
+	, Chunks()
+	, ValueColors()
+	, ChunkSections()
+	, DirtyChunks()
+	, MeshTasks()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+	bTickInEditor = true;
+	bUseAsyncCooking = true;
+}
+
+#if WITH_EDITOR
+void UVoxelMeshComponent::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	static const FName NAME_Voxel = GET_MEMBER_NAME_CHECKED(UVoxelMeshComponent, Voxel);
+	static const FName NAME_ChunkSize = GET_MEMBER_NAME_CHECKED(UVoxelMeshComponent, ChunkSize);
+	static const FName NAME_Material = GET_MEMBER_NAME_CHECKED(UVoxelMeshComponent, Material);
+	static const FName NAME_ChunkCollision = GET_MEMBER_NAME_CHECKED(UVoxelMeshComponent, bChunkCollision);
+	if (PropertyChangedEvent.Property)
+	{
+		const FName PropertyName = PropertyChangedEvent.Property->GetFName();
+		if (PropertyName == NAME_Voxel || PropertyName == NAME_ChunkSize || PropertyName == NAME_ChunkCollision)
+		{
+			RebuildVoxel();
+		}
+		else if (PropertyName == NAME_Material)
+		{
+			for (const auto& ChunkSection : ChunkSections)
+			{
+				SetMaterial(ChunkSection.Value, GetChunkMaterial());
+			}
+		}
+	}
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+}
+#endif // WITH_EDITOR
+
+/**
+ * Sections are meshed again from the voxel, so generated chunk meshes are not written into saved levels
+ * Cells stay in the chunks and every chunk is meshed again on the next tick
+ */
+void UVoxelMeshComponent::PreSave(FObjectPreSaveContext SaveContext)
+{
+	if (Voxel && !HasAnyFlags(RF_Transient) && !GetOutermost()->HasAnyFlags(RF_Transient))
+	{
+		ClearAllMeshSections();
+		ChunkSections.Empty();
+		MeshTasks.Empty();
+		for (const auto& Chunk : Chunks)
+		{
+			DirtyChunks.Add(Chunk.Key);
+		}
+		SetComponentTickEnabled(0 < DirtyChunks.Num());
+	}
+	Super::PreSave(SaveContext);
+}
+
+void UVoxelMeshComponent::OnRegister()
+{
+	Super::OnRegister();
+	if (Voxel && Chunks.Num() == 0)
+	{
+		RebuildVoxel();
+	}
+}
+
+void UVoxelMeshComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	LaunchMeshTasks();
+	ApplyMeshTasks();
+	if (!IsMeshing())
+	{
+		SetComponentTickEnabled(false);
+	}
+}
+
+void UVoxelMeshComponent::SetVoxel(UVoxel* InVoxel, bool bForce /*= false*/)
+{
+	if (Voxel != InVoxel || bForce)
+	{
+		Voxel = InVoxel;
+		RebuildVoxel();
+	}
+}
+
+const UVoxel* UVoxelMeshComponent::GetVoxel() const
+{
+	return Voxel;
+}
+
+void UVoxelMeshComponent::RebuildVoxel()
+{
+	ClearAllMeshSections();
+	Chunks.Empty();
+	ValueColors.Empty();
+	ChunkSections.Empty();
+	DirtyChunks.Empty();
+	MeshTasks.Empty();
+	if (!Voxel)
+	{
+		return;
+	}
+
+	// Palette color of each stored cell, empty cells stay empty
+	ValueColors.Init(0, 257);
+	for (int32 Value = 0; Value < 256; ++Value)
+	{
+		ValueColors[Value + 1] = Voxel->GetColor((uint8)Value);
+	}
+
+	const int32 NumChunkCells = ChunkSize * ChunkSize * ChunkSize;
+	for (const auto& Cell : Voxel->Voxels)
+	{
+		const FIntVector ChunkCoord = GetChunkCoord(Cell.Key);
+		TArray<uint16>* Chunk = Chunks.Find(ChunkCoord);
+		if (!Chunk)
+		{
+			Chunk = &Chunks.Add(ChunkCoord);
+			Chunk->Init(0, NumChunkCells);
+			DirtyChunks.Add(ChunkCoord);
+		}
+		const FIntVector Local = Cell.Key - ChunkCoord * ChunkSize;
+		(*Chunk)[(Local.Z * ChunkSize + Local.Y) * ChunkSize + Local.X] = (uint16)Cell.Value + 1;
+	}
+	SetComponentTickEnabled(true);
+}
+
+bool UVoxelMeshComponent::TryGetCell(const FIntVector& InVector, uint8& OutValue) const
+{
+	const uint16 Cell = GetChunkCell(InVector);
+	if (Cell == 0)
+	{
+		return false;
+	}
+	OutValue = (uint8)(Cell - 1);
+	return true;
+}
+
+void UVoxelMeshComponent::SetCell(const FIntVector& InVector, uint8 Value)
+{
+	SetChunkCell(InVector, (uint16)Value + 1);
+}
+
+void UVoxelMeshComponent::RemoveCell(const FIntVector& InVector)
+{
+	SetChunkCell(InVector, 0);
+}
+
+void UVoxelMeshComponent::FillBox(const FIntVector& InMin, const FIntVector& InMax, uint8 Value)
+{
+	for (int32 Z = FMath::Min(InMin.Z, InMax.Z); Z <= FMath::Max(InMin.Z, InMax.Z); ++Z)
+	{
+		for (int32 Y = FMath::Min(InMin.Y, InMax.Y); Y <= FMath::Max(InMin.Y, InMax.Y); ++Y)
+		{
+			for (int32 X = FMath::Min(InMin.X, InMax.X); X <= FMath::Max(InMin.X, InMax.X); ++X)
+			{
+				SetCell(FIntVector(X, Y, Z), Value);
+			}
+		}
+	}
+}
+
+void UVoxelMeshComponent::CarveSphere(const FIntVector& InCenter, float Radius)
+{
+	const int32 Extent = FMath::FloorToInt32(FMath::Max(Radius, 0.f));
+	const float RadiusSquared = Radius * Radius;
+	for (int32 Z = -Extent; Z <= Extent; ++Z)
+	{
+		for (int32 Y = -Extent; Y <= Extent; ++Y)
+		{
+			for (int32 X = -Extent; X <= Extent; ++X)
+			{
+				if ((float)(X * X + Y * Y + Z * Z) <= RadiusSquared)
+				{
+					SetChunkCell(InCenter + FIntVector(X, Y, Z), 0);
+				}
+			}
+		}
+	}
+}
+
+bool UVoxelMeshComponent::IsMeshing() const
+{
+	return 0 < DirtyChunks.Num() || 0 < MeshTasks.Num();
+}
+
+uint16 UVoxelMeshComponent::GetChunkCell(const FIntVector& InVector) const
+{
+	const FIntVector ChunkCoord = GetChunkCoord(InVector);
+	const TArray<uint16>* Chunk = Chunks.Find(ChunkCoord);
+	if (!Chunk)
+	{
+		return 0;
+	}
+	const FIntVector Local = InVector - ChunkCoord * ChunkSize;
+	return (*Chunk)[(Local.Z * ChunkSize + Local.Y) * ChunkSize + Local.X];
+}
+
+/**
+ * Write stored cell and mark its chunks dirty when it changed
+ * @param InVector Cell position
+ * @param Cell Voxel value plus one, zero removes the cell
+ */
+void UVoxelMeshComponent::SetChunkCell(const FIntVector& InVector, uint16 Cell)
+{
+	const FIntVector ChunkCoord = GetChunkCoord(InVector);
+	TArray<uint16>* Chunk = Chunks.Find(ChunkCoord);
+	if (!Chunk)
+	{
+		if (Cell == 0)
+		{
+			return;
+		}
+		Chunk = &Chunks.Add(ChunkCoord);
+		Chunk->Init(0, ChunkSize * ChunkSize * ChunkSize);
+	}
+	const FIntVector Local = InVector - ChunkCoord * ChunkSize;
+	uint16& ChunkCell = (*Chunk)[(Local.Z * ChunkSize + Local.Y) * ChunkSize + Local.X];
+	if (ChunkCell != Cell)
+	{
+		ChunkCell = Cell;
+		MarkCellDirty(InVector);
+	}
+}
+
+/**
+ * Mark chunk of cell dirty, cells on a chunk face also change faces owned by the neighbour chunk
+ * Edits of one frame are meshed together on the next tick
+ * @param InVector Edited cell
+ */
+void UVoxelMeshComponent::MarkCellDirty(const FIntVector& InVector)
+{
+	const FIntVector ChunkCoord = GetChunkCoord(InVector);
+	const FIntVector Local = InVector - ChunkCoord * ChunkSize;
+	DirtyChunks.Add(ChunkCoord);
+	for (int32 Dimension = 0; Dimension < 3; ++Dimension)
+	{
+		FIntVector Step = FIntVector::ZeroValue;
+		Step[Dimension] = Local[Dimension] == 0 ? -1 : Local[Dimension] == ChunkSize - 1 ? 1 : 0;
+		if (Step != FIntVector::ZeroValue && Chunks.Contains(ChunkCoord + Step))
+		{
+			DirtyChunks.Add(ChunkCoord + Step);
+		}
+	}
+	SetComponentTickEnabled(true);
+}
+
+/**
+ * Copy chunk with one cell border taken from the neighbouring chunks, voxel values become palette colors
+ * Values without palette color are left empty
+ * @param OutCells Out palette colors, x-fastest
+ * @param ChunkCoord Chunk coordinate
+ */
+void UVoxelMeshComponent::CreatePaddedChunk(TArray<uint8>& OutCells, const FIntVector& ChunkCoord) const
+{
+	const int32 Extent = ChunkSize + 2;
+	OutCells.Init(0, Extent * Extent * Extent);
+	if (ValueColors.Num() != 257)
+	{
+		return;
+	}
+	const uint8* Colors = ValueColors.GetData();
+
+	const uint16* Neighbours[27];
+	for (int32 Index = 0; Index < 27; ++Index)
+	{
+		const TArray<uint16>* Chunk = Chunks.Find(ChunkCoord + FIntVector(Index % 3 - 1, (Index / 3) % 3 - 1, Index / 9 - 1));
+		Neighbours[Index] = Chunk ? Chunk->GetData() : nullptr;
+	}
+
+	auto GetSide = [this](int32 P, int32& OutLocal)
+	{
+		const int32 Side = P == 0 ? 0 : P <= ChunkSize ? 1 : 2;
+		OutLocal = Side == 0 ? ChunkSize - 1 : Side == 1 ? P - 1 : 0;
+		return Side;
+	};
+
+	for (int32 Z = 0; Z < Extent; ++Z)
+	{
+		int32 LocalZ;
+		const int32 SideZ = GetSide(Z, LocalZ);
+		for (int32 Y = 0; Y < Extent; ++Y)
+		{
+			int32 LocalY;
+			const int32 SideY = GetSide(Y, LocalY);
+			const int32 RowOffset = (LocalZ * ChunkSize + LocalY) * ChunkSize;
+			const int32 Neighbour = SideZ * 9 + SideY * 3;
+			uint8* Row = &OutCells[(Z * Extent + Y) * Extent];
+			Row[0] = Neighbours[Neighbour] ? Colors[Neighbours[Neighbour][RowOffset + ChunkSize - 1]] : 0;
+			if (const uint16* Cells = Neighbours[Neighbour + 1])
+			{
+				for (int32 X = 0; X < ChunkSize; ++X)
+				{
+					Row[X + 1] = Colors[Cells[RowOffset + X]];
+				}
+			}
+			Row[Extent - 1] = Neighbours[Neighbour + 2] ? Colors[Neighbours[Neighbour + 2][RowOffset]] : 0;
+		}
+	}
+}
+
+/**
+ * Snapshot every dirty chunk and mesh it on the thread pool
+ * A chunk edited while its task runs gets a new task, results of the older one are dropped
+ */
+void UVoxelMeshComponent::LaunchMeshTasks()
+{
+	if (!Voxel || DirtyChunks.Num() == 0)
+	{
+		return;
+	}
+
+	const FVector CellSize = Voxel->CellBounds.BoxExtent * 2;
+	const FVector Offset = Voxel->bXYCenter ? FVector((float)Voxel->Size.X, (float)Voxel->Size.Y, 0.f) * Voxel->CellBounds.BoxExtent : FVector::ZeroVector;
+	for (const FIntVector& ChunkCoord : DirtyChunks)
+	{
+		TArray<uint8> Cells;
+		CreatePaddedChunk(Cells, ChunkCoord);
+		const FVector Origin = FVector(ChunkCoord * ChunkSize) * CellSize - Offset;
+		TSharedPtr<FVoxelMeshTask> Task = MakeShared<FVoxelMeshTask>();
+		Task->Future = Async(EAsyncExecution::ThreadPool, [Task, Cells = MoveTemp(Cells), Size = ChunkSize, Origin, CellSize]()
+		{
+			FVoxelGreedyMesher::CreateChunkMesh(Task->Mesh, Cells, Size, Origin, CellSize);
+		});
+		MeshTasks.Add(ChunkCoord, Task);
+	}
+	DirtyChunks.Reset();
+}
+
+/**
+ * Replace sections of chunks whose meshing finished, collision is cooked asynchronously by the component
+ */
+void UVoxelMeshComponent::ApplyMeshTasks()
+{
+	for (auto It = MeshTasks.CreateIterator(); It; ++It)
+	{
+		FVoxelMeshTask& Task = *It.Value();
+		if (!Task.Future.IsReady())
+		{
+			continue;
+		}
+
+		const FVoxelChunkMesh& Mesh = Task.Mesh;
+		const int32* Section = ChunkSections.Find(It.Key());
+		if (Mesh.Triangles.Num() == 0)
+		{
+			if (Section)
+			{
+				ClearMeshSection(*Section);
+			}
+		}
+		else
+		{
+			const int32 SectionIndex = Section ? *Section : ChunkSections.Add(It.Key(), ChunkSections.Num());
+			CreateMeshSection(SectionIndex, Mesh.Vertices, Mesh.Triangles, Mesh.Normals, Mesh.UV0, TArray<FColor>(), Mesh.Tangents, bChunkCollision);
+			SetMaterial(SectionIndex, GetChunkMaterial());
+		}
+		It.RemoveCurrent();
+	}
+}
+
+UMaterialInterface* UVoxelMeshComponent::GetChunkMaterial() const
+{
+	return Material || !Voxel ? Material : Voxel->PaletteMaterial;
+}
+
+FIntVector UVoxelMeshComponent::GetChunkCoord(const FIntVector& InVector) const
+{
+	auto FloorDiv = [this](int32 Value)
+	{
+		return 0 <= Value ? Value / ChunkSize : (Value + 1) / ChunkSize - 1;
+	};
+	return FIntVector(FloorDiv(InVector.X), FloorDiv(InVector.Y), FloorDiv(InVector.Z));
+}
@@ -8,6 +8,7 @@
 #include <Delegates/DelegateSignatureImpl.inl>
 #include "Voxel.generated.h"
 
+class UMaterialInterface;
 class UStaticMesh;
 
 /**
@@ -29,9 +30,21 @@ public:
 	UPROPERTY(EditDefaultsOnly, Category = Voxel)
 	uint32 bXYCenter : 1;
 
+	/** One shared cube mesh, voxel values are palette indices passed as per-instance custom data */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Voxel)
+	uint32 bPaletteInstancing : 1;
+
 	UPROPERTY(EditDefaultsOnly, EditFixedSize, Category = Voxel)
 	TArray<UStaticMesh*> Meshes;
 
+	/** Palette color of each mesh, empty with palette instancing */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Voxel)
+	TArray<uint8> MeshColors;
+
+	/** Material sampling the palette texture of every color, none when each color has its own material */
+	UPROPERTY(EditDefaultsOnly, Category = Voxel)
+	UMaterialInterface* PaletteMaterial;
+
 	UPROPERTY(EditDefaultsOnly, Category = Voxel)
 	TMap<FIntVector, uint8> Voxels;
 
@@ -44,6 +57,18 @@ public:
 
 	UVoxel();
 
+	/** Mesh index of voxel value */
+	int32 GetMeshIndex(uint8 Value) const
+	{
+		return bPaletteInstancing ? 0 : Value;
+	}
+
+	/** Palette color of voxel value, zero when unknown */
+	uint8 GetColor(uint8 Value) const
+	{
+		return bPaletteInstancing ? Value : MeshColors.IsValidIndex(Value) ? MeshColors[Value] : 0;
+	}
+
 #if WITH_EDITORONLY_DATA
 
 	class UAssetImportData* GetAssetImportData() const;
@@ -11,6 +11,18 @@ class UInstancedStaticMeshComponent;
 class UStaticMesh;
 class UVoxel;
 
+/**
+ * @struct FVoxelChunkInstances
+ * Instanced static meshes of one chunk and bounds of its shown cells
+ */
+struct FVoxelChunkInstances
+{
+	/** Index in instanced static mesh components of each mesh, INDEX_NONE until the chunk shows a cell of it */
+	TArray<int32> Proxies;
+	/** Component space bounds of shown cells */
+	FBox Bounds = FBox(ForceInit);
+};
+
 /**
  * Voxel component
  */
@@ -27,11 +39,25 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = VoxelComponent)
 	bool bHideUnbeheld;
 
+	/** Edge length in cells of chunks culled and updated on their own */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = VoxelComponent, meta = (ClampMin = "1"))
+	int32 ChunkSize;
+
+	/** Mesh of each mesh index, filled from the voxel asset and editable per component. None falls back to the asset mesh */
 	UPROPERTY(EditAnywhere, EditFixedSize, BlueprintReadWrite, Category = VoxelComponent)
 	TArray<UStaticMesh*> Meshes;
 
-	UPROPERTY(EditAnywhere, EditFixedSize, BlueprintReadWrite, Category = VoxelComponent)
-	TMap<FIntVector, uint8> Cells;
+	/** Cells of this component set to a value differing from the voxel asset. Empty until the component is edited */
+	UPROPERTY()
+	TMap<FIntVector, uint8> CellEdits;
+
+	/** Asset cells removed by this component */
+	UPROPERTY()
+	TSet<FIntVector> RemovedCells;
+
+	/** Full copy of the asset cells saved by older versions, folded into CellEdits and RemovedCells on load */
+	UPROPERTY(BlueprintReadWrite, Category = VoxelComponent, meta = (DeprecatedProperty, DeprecationMessage = "Cells are no longer copied per component, use TryGetCell, SetCell and RemoveCell"))
+	TMap<FIntVector, uint8> Cells_DEPRECATED;
 
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = VoxelComponent)
 	UVoxel* Voxel;
@@ -50,12 +76,44 @@ public:
 
 	const UVoxel* GetVoxel() const;
 
+	virtual void PostLoad() override;
+
+	virtual void OnRegister() override;
+
+	/** Cell value with edits applied, returns false when the cell is empty */
+	UFUNCTION(BlueprintCallable, Category = Voxel)
+	bool TryGetCell(const FIntVector& InVector, uint8& OutValue) const;
+
 	UFUNCTION(BlueprintCallable, Category = Voxel)
 	void AddVoxel();
 
 	UFUNCTION(BlueprintCallable, Category = Voxel)
 	void ClearVoxel();
 
+	/** Defer instance updates of following edits until the matching EndEdit, scopes may nest */
+	UFUNCTION(BlueprintCallable, Category = Voxel)
+	void BeginEdit();
+
+	/** Close edit scope, the outermost scope updates instances of edited cells and their neighbours */
+	UFUNCTION(BlueprintCallable, Category = Voxel)
+	void EndEdit();
+
+	/** Set cell value, every value including zero is a cell. RemoveCell empties it */
+	UFUNCTION(BlueprintCallable, Category = Voxel)
+	void SetCell(const FIntVector& InVector, uint8 Value);
+
+	/** Remove cell */
+	UFUNCTION(BlueprintCallable, Category = Voxel)
+	void RemoveCell(const FIntVector& InVector);
+
+	/** Set every cell of inclusive box */
+	UFUNCTION(BlueprintCallable, Category = Voxel)
+	void FillBox(const FIntVector& InMin, const FIntVector& InMax, uint8 Value);
+
+	/** Remove every cell whose center lies within radius of center cell */
+	UFUNCTION(BlueprintCallable, Category = Voxel)
+	void CarveSphere(const FIntVector& InCenter, float Radius);
+
 	UFUNCTION(BlueprintCallable, Category = Voxel)
 	bool IsUnbeheldVolume(const FIntVector& InVector) const;
 
@@ -70,9 +128,51 @@ private:
 
 	void InitVoxel();
 
+	/** Component space translation of cell */
+	FVector GetCellTranslation(const FIntVector& InVector) const;
+
+	/** Value of an occupied cell */
+	uint8 GetCellValue(const FIntVector& InVector) const;
+
+	/** Write cell and mark it dirty, unset value removes the cell */
+	void EditCell(const FIntVector& InVector, TOptional<uint8> Value);
+
+	/** Update instances of dirty cells and of neighbours whose visibility may have changed */
+	void FlushEdits();
+
+	/** Instanced static mesh of chunk showing cells of mesh */
+	int32 GetProxy(const FIntVector& ChunkCoord, int32 MeshIndex);
+
+	/** Recompute cached bounds of chunk */
+	void UpdateChunkBounds(const FIntVector& ChunkCoord);
+
+	/** Chunk holding cell */
+	FIntVector GetChunkCoord(const FIntVector& InVector) const;
+
+	/** Component space box of cell */
+	FBox GetCellBox(const FIntVector& InVector) const;
+
 protected:
 
-	UPROPERTY()
+	UPROPERTY(Transient)
 	TArray<UInstancedStaticMeshComponent*> InstancedStaticMeshComponents;
 
+	/** Mesh index of each instanced static mesh */
+	TArray<int32> ProxyMeshes;
+
+	/** Instanced static meshes and cached bounds of each chunk */
+	TMap<FIntVector, FVoxelChunkInstances> ChunkInstances;
+
+	/** Cell of each instance, per instanced static mesh */
+	TArray<TArray<FIntVector>> InstanceCells;
+
+	/** Instanced static mesh index and instance index of each shown cell */
+	TMap<FIntVector, FIntPoint> CellInstances;
+
+	/** Cells edited in the open edit scope */
+	TSet<FIntVector> DirtyCells;
+
+	/** Depth of nested edit scopes */
+	int32 EditDepth;
+
 };
\ No newline at end of file
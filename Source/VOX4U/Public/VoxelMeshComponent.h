@@ -0,0 +1,127 @@
+// Copyright (c) 2025 Muppetsg2
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <CoreMinimal.h>
+#include <ProceduralMeshComponent.h>
+#include "VoxelMeshComponent.generated.h"
+
+class UMaterialInterface;
+class UVoxel;
+struct FVoxelMeshTask;
+
+/**
+ * Voxel component rendering cells as greedy meshed chunks instead of one instance per cell
+ * Each chunk is one mesh section, edited chunks are meshed again on background tasks
+ */
+UCLASS(ClassGroup = Rendering, meta = (BlueprintSpawnableComponent))
+class VOX4U_API UVoxelMeshComponent : public UProceduralMeshComponent
+{
+	GENERATED_BODY()
+
+protected:
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = VoxelMeshComponent)
+	UVoxel* Voxel;
+
+	/** Edge length of one chunk in cells */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = VoxelMeshComponent, meta = (ClampMin = "1", ClampMax = "64"))
+	int32 ChunkSize;
+
+	/** Material of every chunk, samples the palette texture at the UV0 of the cell color. Palette material of the voxel when none */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = VoxelMeshComponent)
+	UMaterialInterface* Material;
+
+	/** Create collision of chunk sections, cooked asynchronously */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = VoxelMeshComponent)
+	bool bChunkCollision;
+
+public:
+
+	UVoxelMeshComponent(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+
+#if WITH_EDITOR
+
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+
+#endif // WITH_EDITOR
+
+	virtual void PreSave(FObjectPreSaveContext SaveContext) override;
+
+	virtual void OnRegister() override;
+
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	void SetVoxel(UVoxel* InVoxel, bool bForce = false);
+
+	const UVoxel* GetVoxel() const;
+
+	/** Copy cells of voxel asset and mesh every chunk */
+	UFUNCTION(BlueprintCallable, Category = Voxel)
+	void RebuildVoxel();
+
+	/** Cell value, false when empty */
+	UFUNCTION(BlueprintCallable, Category = Voxel)
+	bool TryGetCell(const FIntVector& InVector, uint8& OutValue) const;
+
+	/** Set cell value, every value including zero is a cell. Values without palette color are kept but not drawn. Chunks are meshed again on the next tick */
+	UFUNCTION(BlueprintCallable, Category = Voxel)
+	void SetCell(const FIntVector& InVector, uint8 Value);
+
+	/** Remove cell */
+	UFUNCTION(BlueprintCallable, Category = Voxel)
+	void RemoveCell(const FIntVector& InVector);
+
+	/** Set every cell of inclusive box */
+	UFUNCTION(BlueprintCallable, Category = Voxel)
+	void FillBox(const FIntVector& InMin, const FIntVector& InMax, uint8 Value);
+
+	/** Remove every cell whose center lies within radius of center cell */
+	UFUNCTION(BlueprintCallable, Category = Voxel)
+	void CarveSphere(const FIntVector& InCenter, float Radius);
+
+	/** True while edited chunks wait for their mesh */
+	UFUNCTION(BlueprintCallable, Category = Voxel)
+	bool IsMeshing() const;
+
+private:
+
+	/** Stored cell, voxel value plus one and zero when empty */
+	uint16 GetChunkCell(const FIntVector& InVector) const;
+
+	void SetChunkCell(const FIntVector& InVector, uint16 Cell);
+
+	/** Mark chunk of cell dirty, and neighbour chunks sharing a face with it */
+	void MarkCellDirty(const FIntVector& InVector);
+
+	/** Copy chunk with one cell border of neighbour chunks */
+	void CreatePaddedChunk(TArray<uint8>& OutCells, const FIntVector& ChunkCoord) const;
+
+	/** Start meshing of dirty chunks */
+	void LaunchMeshTasks();
+
+	/** Apply finished meshes to their sections */
+	void ApplyMeshTasks();
+
+	UMaterialInterface* GetChunkMaterial() const;
+
+	FIntVector GetChunkCoord(const FIntVector& InVector) const;
+
+private:
+
+	/** Voxel values plus one of each chunk by chunk coordinate, x-fastest. Zero is empty */
+	TMap<FIntVector, TArray<uint16>> Chunks;
+
+	/** Palette color of each stored cell, taken from the voxel asset when cells are copied */
+	TArray<uint8> ValueColors;
+
+	/** Mesh section of each meshed chunk */
+	TMap<FIntVector, int32> ChunkSections;
+
+	/** Chunks edited since their last meshing started */
+	TSet<FIntVector> DirtyChunks;
+
+	/** Latest running mesh task of each chunk */
+	TMap<FIntVector, TSharedPtr<FVoxelMeshTask>> MeshTasks;
+};
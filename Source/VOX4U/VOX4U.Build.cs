@@ -23,6 +23,7 @@ public class VOX4U : ModuleRules
 			new string[]
 			{
 				"Core",
+				"ProceduralMeshComponent",
 			}
 		);
 
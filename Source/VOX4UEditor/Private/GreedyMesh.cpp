@@ -0,0 +1,189 @@
+// Copyright (c) 2025 Muppetsg2
+// Licensed under the MIT License.
+
+#include "GreedyMesh.h"
+#include "Vox.h"
+#include "VoxImportOption.h"
+#include "VoxMeshBuilder.h"
+#include "VoxVolume.h"
+
+DEFINE_LOG_CATEGORY_STATIC(Greedy, Log, All)
+
+/**
+ * Construct mesh generator using referenced voxel
+ */
+GreedyMesh::GreedyMesh(const FVox* InVox)
+{
+	Vox = InVox;
+}
+
+/**
+ * CreateMeshDescription
+ * Create mesh description use greedy rectangle merging
+ */
+bool GreedyMesh::CreateMeshDescription(FMeshDescription& OutMeshDescription, const UVoxImportOption* ImportOption, const uint32 ModelId) const
+{
+	FVoxVolume Volume;
+	Vox->CreateVolume(Volume, ImportOption, ModelId);
+
+	FVoxMaterialSlots MaterialSlots;
+	FVoxMeshBuilder::CreateMaterialSlots(MaterialSlots, Vox, ImportOption, ModelId);
+
+	return CreateMeshDescription(OutMeshDescription, Volume, MaterialSlots, Vox->GetMeshOffset(ImportOption, ModelId), ImportOption->bForceSerialMeshing);
+}
+
+/**
+ * CreateMeshDescription
+ * Create mesh description of faces owned by volume, chunks and levels of one model share lattice and offset
+ * @param OutMeshDescription Out mesh description
+ * @param Volume Voxel volume
+ * @param MaterialSlots Material slot of each color
+ * @param Offset Mesh space position of model origin
+ * @param bSerial Create planes on calling thread only
+ */
+bool GreedyMesh::CreateMeshDescription(FMeshDescription& OutMeshDescription, const FVoxVolume& Volume, const FVoxMaterialSlots& MaterialSlots, const FVector3f& Offset, const bool bSerial) const
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	TArray<FVoxPlaneMesh> PlaneMeshes;
+	FVoxMeshBuilder::SweepPlanes(PlaneMeshes, Volume, bSerial, [&](FVoxPlaneMesh& OutPlane, const FIntVector& Plane, const FIntVector& Axis)
+	{
+		CreatePlane(OutPlane, Plane, Axis, Volume);
+	});
+
+	FVoxMeshBuilder Builder(OutMeshDescription, MaterialSlots);
+	Builder.Append(PlaneMeshes);
+	Builder.Finish(FVector3f(Volume.Origin.X, Volume.Origin.Y, Volume.Origin.Z) * Volume.CellSize + Offset, (float)Volume.CellSize);
+	UE_LOG(Greedy, Log, TEXT("Welded %d of %d vertices"), Builder.GetNumVertices(), Builder.GetNumWrittenVertices());
+
+	const double ElapsedTime = FPlatformTime::Seconds() - StartTime;
+	UE_LOG(Greedy, Log, TEXT("Meshed %d voxels in %.2f ms (%.3f us per voxel)"), Volume.NumVoxels, ElapsedTime * 1000.0, 0 < Volume.NumVoxels ? ElapsedTime * 1000000.0 / Volume.NumVoxels : 0.0);
+	return true;
+}
+
+/**
+ * CreatePlane
+ * Merge faces of one plane to rectangles, reads the volume only
+ * @param OutPlane Out plane mesh
+ * @param Plane Coordinate for polygon faces
+ * @param Axis Component index of scan faces
+ * @param Volume Voxel volume shared by every plane
+ */
+void GreedyMesh::CreatePlane(FVoxPlaneMesh& OutPlane, const FIntVector& Plane, const FIntVector& Axis, const FVoxVolume& Volume) const
+{
+	const int32 Width = Volume.Size[Axis.X];
+	const int32 Height = Volume.Size[Axis.Y];
+
+	TArray<int32> Mask;
+	CreateMask(Mask, Plane, Axis, Volume);
+
+	for (int32 Y = 0; Y < Height; ++Y)
+	{
+		for (int32 X = 0; X < Width;)
+		{
+			const int32 Color = Mask[Y * Width + X];
+			if (Color == 0)
+			{
+				++X;
+				continue;
+			}
+
+			int32 Right = X + 1;
+			while (Right < Width && Mask[Y * Width + Right] == Color)
+			{
+				++Right;
+			}
+
+			int32 Top = Y + 1;
+			for (; Top < Height; ++Top)
+			{
+				bool bRowMatch = true;
+				for (int32 i = X; i < Right; ++i)
+				{
+					if (Mask[Top * Width + i] != Color)
+					{
+						bRowMatch = false;
+						break;
+					}
+				}
+				if (!bRowMatch)
+				{
+					break;
+				}
+			}
+
+			for (int32 j = Y; j < Top; ++j)
+			{
+				for (int32 i = X; i < Right; ++i)
+				{
+					Mask[j * Width + i] = 0;
+				}
+			}
+
+			WriteQuad(OutPlane, Axis, Color, X, Y, Right, Top, Plane[Axis.Z]);
+			X = Right;
+		}
+	}
+}
+
+/**
+ * CreateMask
+ * Signed face color of every cell in plane, negative faces look toward the positive axis
+ * @param OutMask Out face colors, x-fastest
+ * @param Plane Coordinate for polygon faces
+ * @param Axis Component index of scan faces
+ * @param Volume Voxel volume shared by every plane
+ */
+void GreedyMesh::CreateMask(TArray<int32>& OutMask, const FIntVector& Plane, const FIntVector& Axis, const FVoxVolume& Volume) const
+{
+	const int32 Width = Volume.Size[Axis.X];
+	const int32 Height = Volume.Size[Axis.Y];
+	OutMask.Init(0, Width * Height);
+
+	for (int32 Y = 0; Y < Height; ++Y)
+	{
+		int32* Row = &OutMask[Y * Width];
+		Volume.ForEachFaceRun(Axis.X, Y, Plane[Axis.Z], [Row](int32 Color, int32 Left, int32 Right)
+		{
+			for (int32 X = Left; X < Right; ++X)
+			{
+				Row[X] = Color;
+			}
+		});
+	}
+}
+
+/**
+ * WriteQuad
+ * Write rectangle as two triangles with the winding of the monotone mesh
+ * @param OutPlane Out plane mesh
+ * @param Axis Component index of scan faces
+ * @param Color Signed face color
+ */
+void GreedyMesh::WriteQuad(FVoxPlaneMesh& OutPlane, const FIntVector& Axis, int Color, int Left, int Bottom, int Right, int Top, int Depth)
+{
+	const auto ToLattice = [&Axis, Depth](int X, int Y) -> FIntVector
+	{
+		FIntVector Lattice;
+		Lattice[Axis.X] = X;
+		Lattice[Axis.Y] = Y;
+		Lattice[Axis.Z] = Depth;
+		return Lattice;
+	};
+
+	const int32 Index0 = OutPlane.AddVertex(ToLattice(Left, Bottom));
+	const int32 Index1 = OutPlane.AddVertex(ToLattice(Right, Bottom));
+	const int32 Index2 = OutPlane.AddVertex(ToLattice(Left, Top));
+	const int32 Index3 = OutPlane.AddVertex(ToLattice(Right, Top));
+	const uint8 ColorIndex = (uint8)(0 < Color ? Color : -Color);
+	if (0 < Color)
+	{
+		OutPlane.AddTriangle(Index0, Index1, Index2, ColorIndex);
+		OutPlane.AddTriangle(Index2, Index1, Index3, ColorIndex);
+	}
+	else
+	{
+		OutPlane.AddTriangle(Index1, Index0, Index2, ColorIndex);
+		OutPlane.AddTriangle(Index1, Index2, Index3, ColorIndex);
+	}
+}
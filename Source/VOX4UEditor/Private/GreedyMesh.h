@@ -0,0 +1,42 @@
+// Copyright (c) 2025 Muppetsg2
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <CoreMinimal.h>
+#include <MeshDescription.h>
+#include "VoxMeshBuilder.h"
+
+struct FVox;
+struct FVoxPlaneMesh;
+struct FVoxVolume;
+class UVoxImportOption;
+
+/**
+ * Greedy quad mesh generation
+ * @see https://0fps.net/2012/06/30/meshing-in-a-minecraft-game/
+ */
+class GreedyMesh
+{
+public:
+
+	/** Construct mesh generator */
+	GreedyMesh(const FVox* InVox);
+
+	/** Create FMeshDescription from Voxel */
+	bool CreateMeshDescription(FMeshDescription& OutMeshDescription, const UVoxImportOption* ImportOption, const uint32 ModelId) const;
+
+	/** Create FMeshDescription from owned cells of volume */
+	bool CreateMeshDescription(FMeshDescription& OutMeshDescription, const FVoxVolume& Volume, const FVoxMaterialSlots& MaterialSlots, const FVector3f& Offset, const bool bSerial) const;
+
+private:
+
+	void CreatePlane(FVoxPlaneMesh& OutPlane, const FIntVector& Plane, const FIntVector& Axis, const FVoxVolume& Volume) const;
+	void CreateMask(TArray<int32>& OutMask, const FIntVector& Plane, const FIntVector& Axis, const FVoxVolume& Volume) const;
+
+	static void WriteQuad(FVoxPlaneMesh& OutPlane, const FIntVector& Axis, int Color, int Left, int Bottom, int Right, int Top, int Depth);
+
+private:
+
+	const FVox* Vox;
+};
@@ -4,6 +4,8 @@
 #include "MonotoneMesh.h"
 #include "Vox.h"
 #include "VoxImportOption.h"
+#include "VoxMeshBuilder.h"
+#include "VoxVolume.h"
 
 DEFINE_LOG_CATEGORY_STATIC(Monotone, Log, All)
 
@@ -16,46 +18,66 @@ MonotoneMesh::MonotoneMesh(const FVox* InVox)
 }
 
 /**
- * CreateRawMesh
- * Create raw mesh use monotone decomposition algorithm
+ * CreateMeshDescription
+ * Create mesh description use monotone decomposition algorithm
+ * Planes are swept in parallel and merged in sweep order, so the result does not depend on scheduling
  */
-bool MonotoneMesh::CreateRawMesh(FRawMesh& OutRawMesh, const UVoxImportOption* ImportOption, const uint32 ModelId) const
+bool MonotoneMesh::CreateMeshDescription(FMeshDescription& OutMeshDescription, const UVoxImportOption* ImportOption, const uint32 ModelId) const
 {
-	FIntVector Size = FIntVector::ZeroValue;
-	if (ImportOption->bSeparateModels)
-	{
-		Size = Vox->Sizes[ModelId];
-	}
-	else
-	{
-		Vox->GetBiggestSize(Size);
-	}
+	FVoxVolume Volume;
+	Vox->CreateVolume(Volume, ImportOption, ModelId);
+
+	FVoxMaterialSlots MaterialSlots;
+	FVoxMeshBuilder::CreateMaterialSlots(MaterialSlots, Vox, ImportOption, ModelId);
+
+	return CreateMeshDescription(OutMeshDescription, Volume, MaterialSlots, Vox->GetMeshOffset(ImportOption, ModelId), ImportOption->bForceSerialMeshing);
+}
+
+/**
+ * CreateMeshDescription
+ * Create mesh description of faces owned by volume, chunks and levels of one model share lattice and offset
+ * @param OutMeshDescription Out mesh description
+ * @param Volume Voxel volume
+ * @param MaterialSlots Material slot of each color
+ * @param Offset Mesh space position of model origin
+ * @param bSerial Create planes on calling thread only
+ */
+bool MonotoneMesh::CreateMeshDescription(FMeshDescription& OutMeshDescription, const FVoxVolume& Volume, const FVoxMaterialSlots& MaterialSlots, const FVector3f& Offset, const bool bSerial) const
+{
+	const double StartTime = FPlatformTime::Seconds();
 
-	for (int32 Dimension = 0; Dimension < 3; ++Dimension)
+	TArray<FVoxPlaneMesh> PlaneMeshes;
+	FVoxMeshBuilder::SweepPlanes(PlaneMeshes, Volume, bSerial, [&](FVoxPlaneMesh& OutPlane, const FIntVector& Plane, const FIntVector& Axis)
 	{
-		FIntVector Plane = FIntVector::ZeroValue;
-		const FIntVector Axis = FIntVector(Dimension, (Dimension + 1) % 3, (Dimension + 2) % 3);
-		for (Plane[Axis.Z] = 0; Plane[Axis.Z] <= Size[Axis.Z]; ++Plane[Axis.Z])
-		{
-			TArray<FPolygon> Polygons;
-			CreatePolygons(Polygons, Plane, Axis, Size, ImportOption->bSeparateModels, ModelId);
-			for (int32 i = 0; i < Polygons.Num(); ++i)
-			{
-				WritePolygon(OutRawMesh, Axis, Polygons[i], ImportOption->bOneMaterial, ImportOption->bSeparateModels, ModelId);
-			}
-		}
-	}
+		CreatePlane(OutPlane, Plane, Axis, Volume);
+	});
 
-	if (ImportOption->bImportXYCenter)
+	FVoxMeshBuilder Builder(OutMeshDescription, MaterialSlots);
+	Builder.Append(PlaneMeshes);
+	Builder.Finish(FVector3f(Volume.Origin.X, Volume.Origin.Y, Volume.Origin.Z) * Volume.CellSize + Offset, (float)Volume.CellSize);
+	UE_LOG(Monotone, Log, TEXT("Welded %d of %d vertices"), Builder.GetNumVertices(), Builder.GetNumWrittenVertices());
+
+	const double ElapsedTime = FPlatformTime::Seconds() - StartTime;
+	UE_LOG(Monotone, Log, TEXT("Meshed %d voxels in %.2f ms (%.3f us per voxel)"), Volume.NumVoxels, ElapsedTime * 1000.0, 0 < Volume.NumVoxels ? ElapsedTime * 1000000.0 / Volume.NumVoxels : 0.0);
+	return true;
+}
+
+/**
+ * CreatePlane
+ * Create triangles of one plane, reads the volume only
+ * @param OutPlane Out plane mesh
+ * @param Plane Coordinate for polygon faces
+ * @param Axis Component index of scan faces
+ * @param Volume Voxel volume shared by every plane
+ */
+void MonotoneMesh::CreatePlane(FVoxPlaneMesh& OutPlane, const FIntVector& Plane, const FIntVector& Axis, const FVoxVolume& Volume) const
+{
+	TArray<FPolygon> Polygons;
+	CreatePolygons(Polygons, Plane, Axis, Volume);
+	for (int32 i = 0; i < Polygons.Num(); ++i)
 	{
-		FVector3f Offset = FVector3f((float)Size.X * 0.5f, (float)Size.Y * 0.5f, 0.f);
-		for (int32 i = 0; i < OutRawMesh.VertexPositions.Num(); ++i)
-		{
-			OutRawMesh.VertexPositions[i] -= Offset;
-		}
+		WritePolygon(OutPlane, Axis, Polygons[i]);
 	}
-	OutRawMesh.CompactMaterialIndices();
-	return true;
 }
 
 /**
@@ -64,16 +86,17 @@ bool MonotoneMesh::CreateRawMesh(FRawMesh& OutRawMesh, const UVoxImportOption* I
  * @param OutPolygons Out polygons
  * @param Plane Coordinate for polygon faces
  * @param Axis Component index of scan faces
+ * @param Volume Voxel volume shared by every plane
  */
-void MonotoneMesh::CreatePolygons(TArray<FPolygon>& OutPolygons, const FIntVector& Plane, const FIntVector& Axis, const FIntVector& ModelSize, const bool SeparateModels, const uint32 ModelId) const
+void MonotoneMesh::CreatePolygons(TArray<FPolygon>& OutPolygons, const FIntVector& Plane, const FIntVector& Axis, const FVoxVolume& Volume) const
 {
 	FIntVector P = Plane;
 	TArray<int32> Frontier;
-	FIntVector Size = ModelSize;
+	const FIntVector& Size = Volume.Size;
 	for (P[Axis.Y] = 0; P[Axis.Y] < Size[Axis.Y]; ++P[Axis.Y])
 	{
 		TArray<FFace> Faces;
-		CreateFaces(Faces, P, Axis, Size, SeparateModels, ModelId);
+		CreateFaces(Faces, P, Axis, Volume);
 		TArray<int32> NextFrontier;
 		int32 FrontierIndex = 0, FaceIndex = 0;
 		while (FrontierIndex < Frontier.Num() && FaceIndex < Faces.Num())
@@ -127,70 +150,32 @@ void MonotoneMesh::CreatePolygons(TArray<FPolygon>& OutPolygons, const FIntVecto
 
 /**
  * CreateFaces
- * Create scan line run faces each side
+ * Create scan line run faces each side from occupancy bits, only cells with a face are visited
  * @param OutFaces Out faces
  * @param Plane Coordinate for polygon faces
  * @param Axis Component index of scan faces
+ * @param Volume Voxel volume shared by every plane
  */
-void MonotoneMesh::CreateFaces(TArray<FFace>& OutFaces, const FIntVector& Plane, const FIntVector& Axis, const FIntVector& ModelSize, const bool SeparateModels, const uint32 ModelId) const
+void MonotoneMesh::CreateFaces(TArray<FFace>& OutFaces, const FIntVector& Plane, const FIntVector& Axis, const FVoxVolume& Volume) const
 {
-	FIntVector P = Plane;
-	FIntVector D = FIntVector::ZeroValue;
-	FIntVector Size = ModelSize;
-	D[Axis.X] = 0, D[Axis.Y] = 0, D[Axis.Z] = -1;
-	int PreviouseColor = 0;
-	for (P[Axis.X] = 0; P[Axis.X] < Size[Axis.X]; ++P[Axis.X])
-	{
-		int Back = 0;
-		int Front = 0;
-		if (SeparateModels)
-		{
-			Back = Vox->Models[ModelId].Voxels.FindRef(P + D);
-			Front = Vox->Models[ModelId].Voxels.FindRef(P);
-		}
-		else
-		{
-			TMap<FIntVector, uint8> ModelData;
-			for (const auto& Model : Vox->Models)
-			{
-				ModelData.Append(Model.Voxels);
-			}
-
-			Back = ModelData.FindRef(P + D);
-			Front = ModelData.FindRef(P);
-		}
-		int Color = !Back == !Front ? 0 : Back ? -Back : Front;
-		if (PreviouseColor != Color)
-		{
-			if (PreviouseColor != 0)
-			{
-				OutFaces.Last().Right = P[Axis.X];
-			}
-			if (Color != 0)
-			{
-				OutFaces.Add(FFace(Color, P[Axis.X], P[Axis.X]));
-			}
-		}
-		PreviouseColor = Color;
-	}
-	if (PreviouseColor != 0)
+	Volume.ForEachFaceRun(Axis.X, Plane[Axis.Y], Plane[Axis.Z], [&OutFaces](int32 Color, int32 Left, int32 Right)
 	{
-		OutFaces.Last().Right = P[Axis.X];
-	}
+		OutFaces.Add(FFace(Color, Left, Right));
+	});
 }
 
 /**
  * WritePolygon
  * Split polygon to triangle mesh
- * @param OutRawMesh Out raw mesh
+ * @param OutPlane Out plane mesh
  * @param Axis Polygon axis
  * @param Polygon Polygon to divide and write
  */
-void MonotoneMesh::WritePolygon(FRawMesh& OutRawMesh, const FIntVector& Axis, const FPolygon& Polygon, const bool OneMaterial, const bool SeparateModels, const uint32 ModelId) const
+void MonotoneMesh::WritePolygon(FVoxPlaneMesh& OutPlane, const FIntVector& Axis, const FPolygon& Polygon)
 {
 	auto LeftIndex = TArray<int>();
 	auto RightIndex = TArray<int>();
-	WriteVertex(OutRawMesh, LeftIndex, RightIndex, Axis, Polygon);
+	WriteVertex(OutPlane, LeftIndex, RightIndex, Axis, Polygon);
 
 	const auto Color = 0 < Polygon.Color ? Polygon.Color : -Polygon.Color;
 	const auto Flipped = Polygon.Color < 0;
@@ -206,19 +191,6 @@ void MonotoneMesh::WritePolygon(FRawMesh& OutRawMesh, const FIntVector& Axis, co
 	List.Add(TPair<int, FIntVector>(LeftIndex[0], Polygon.Left[0]));
 	List.Add(TPair<int, FIntVector>(RightIndex[0], Polygon.Right[0]));
 
-	TArray<uint8> Palette;
-	if (!OneMaterial)
-	{
-		if (SeparateModels)
-		{
-			Vox->GetUniqueColors(Palette, ModelId);
-		}
-		else
-		{
-			Vox->GetUniqueColors(Palette);
-		}
-	}
-
 	while (Left < Polygon.Left.Num() || Right < Polygon.Right.Num())
 	{
 		auto Side = false;
@@ -241,7 +213,7 @@ void MonotoneMesh::WritePolygon(FRawMesh& OutRawMesh, const FIntVector& Axis, co
 			{
 				const auto& First = List[0];
 				const auto& Second = List[1];
-				WriteWedge(OutRawMesh, Flipped == Side, First.Key, Second.Key, Index, Color, OneMaterial, Palette);
+				WriteWedge(OutPlane, Flipped == Side, First.Key, Second.Key, Index, Color);
 				List.RemoveAt(0);
 			}
 		}
@@ -258,7 +230,7 @@ void MonotoneMesh::WritePolygon(FRawMesh& OutRawMesh, const FIntVector& Axis, co
 				}
 				if (Normal != 0)
 				{
-					WriteWedge(OutRawMesh, Flipped == Side, Last.Key, PreviousLast.Key, Index, Color, OneMaterial, Palette);
+					WriteWedge(OutPlane, Flipped == Side, Last.Key, PreviousLast.Key, Index, Color);
 				}
 				List.RemoveAt(List.Num() - 1);
 			}
@@ -271,57 +243,35 @@ void MonotoneMesh::WritePolygon(FRawMesh& OutRawMesh, const FIntVector& Axis, co
 
 /**
  * WriteVertex
- * @param OutRawMesh Out raw mesh
+ * @param OutPlane Out plane mesh
  */
-void MonotoneMesh::WriteVertex(FRawMesh& OutRawMesh, TArray<int>& OutLeftIndex, TArray<int>& OutRightIndex, const FIntVector& Axis, const FPolygon& Polygon)
+void MonotoneMesh::WriteVertex(FVoxPlaneMesh& OutPlane, TArray<int>& OutLeftIndex, TArray<int>& OutRightIndex, const FIntVector& Axis, const FPolygon& Polygon)
 {
+	const auto ToLattice = [&Axis](const FIntVector& Vector) -> FIntVector
+	{
+		FIntVector Lattice;
+		Lattice[Axis.X] = Vector.X;
+		Lattice[Axis.Y] = Vector.Y;
+		Lattice[Axis.Z] = Vector.Z;
+		return Lattice;
+	};
+
 	for (auto i = 0; i < Polygon.Left.Num(); ++i)
 	{
-		auto Vector = Polygon.Left[i];
-		auto Vertex = FVector3f();
-		Vertex[Axis.X] = Vector.X;
-		Vertex[Axis.Y] = Vector.Y;
-		Vertex[Axis.Z] = Vector.Z;
-		const auto UniqueIndex = OutRawMesh.VertexPositions.AddUnique(Vertex);
-		OutLeftIndex.Add(UniqueIndex);
+		OutLeftIndex.Add(OutPlane.AddVertex(ToLattice(Polygon.Left[i])));
 	}
 
 	for (auto i = 0; i < Polygon.Right.Num(); ++i)
 	{
-		auto Vector = Polygon.Right[i];
-		auto Vertex = FVector3f();
-		Vertex[Axis.X] = Vector.X;
-		Vertex[Axis.Y] = Vector.Y;
-		Vertex[Axis.Z] = Vector.Z;
-		const auto UniqueIndex = OutRawMesh.VertexPositions.AddUnique(Vertex);
-		OutRightIndex.Add(UniqueIndex);
+		OutRightIndex.Add(OutPlane.AddVertex(ToLattice(Polygon.Right[i])));
 	}
 }
 
 /**
  * WriteWedge
- * @param OutRawMesh Out raw mesh
+ * @param OutPlane Out plane mesh
  */
-void MonotoneMesh::WriteWedge(FRawMesh& OutRawMesh, bool Face, int Index1, int Index2, int Index3, int ColorIndex, const bool OneMaterial, const TArray<uint8>& Palette)
+void MonotoneMesh::WriteWedge(FVoxPlaneMesh& OutPlane, bool Face, int Index1, int Index2, int Index3, int ColorIndex)
 {
-	OutRawMesh.WedgeIndices.Add(Face ? Index1 : Index2);
-	OutRawMesh.WedgeIndices.Add(Face ? Index2 : Index1);
-	OutRawMesh.WedgeIndices.Add(Index3);
-	OutRawMesh.WedgeTexCoords[0].Add(FVector2f(((double)ColorIndex + 0.5) / 256.0, 0.5));
-	OutRawMesh.WedgeTexCoords[0].Add(FVector2f(((double)ColorIndex + 0.5) / 256.0, 0.5));
-	OutRawMesh.WedgeTexCoords[0].Add(FVector2f(((double)ColorIndex + 0.5) / 256.0, 0.5));
-	if (OneMaterial)
-	{
-		OutRawMesh.FaceMaterialIndices.Add(0);
-	}
-	else
-	{
-		int32 index = Palette.Num() > 0 ? Palette.Num() - 1 : 0;
-		if (Palette.Contains(ColorIndex))
-		{
-			Palette.Find(ColorIndex, index);
-		}
-		OutRawMesh.FaceMaterialIndices.Add(index);
-	}
-	OutRawMesh.FaceSmoothingMasks.Add(0);
-}
\ No newline at end of file
+	OutPlane.AddTriangle(Face ? Index1 : Index2, Face ? Index2 : Index1, Index3, (uint8)ColorIndex);
+}
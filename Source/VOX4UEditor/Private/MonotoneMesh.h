@@ -4,11 +4,14 @@
 #pragma once
 
 #include <CoreMinimal.h>
-#include <RawMesh.h>
+#include <MeshDescription.h>
+#include "VoxMeshBuilder.h"
 
 struct FFace;
 struct FPolygon;
 struct FVox;
+struct FVoxPlaneMesh;
+struct FVoxVolume;
 class UVoxImportOption;
 
 /**
@@ -22,17 +25,21 @@ public:
 	/** Construct mesh generator */
 	MonotoneMesh(const FVox* InVox);
 
-	/** Create FRawMesh from Voxel */
-	bool CreateRawMesh(FRawMesh& OutRawMesh, const UVoxImportOption* ImportOption, const uint32 ModelId) const;
+	/** Create FMeshDescription from Voxel */
+	bool CreateMeshDescription(FMeshDescription& OutMeshDescription, const UVoxImportOption* ImportOption, const uint32 ModelId) const;
+
+	/** Create FMeshDescription from owned cells of volume */
+	bool CreateMeshDescription(FMeshDescription& OutMeshDescription, const FVoxVolume& Volume, const FVoxMaterialSlots& MaterialSlots, const FVector3f& Offset, const bool bSerial) const;
 
 private:
 
-	void CreatePolygons(TArray<FPolygon>& OutPolygons, const FIntVector& Plane, const FIntVector& Axis, const FIntVector& ModelSize, const bool SeparateModels, const uint32 ModelId) const;
-	void CreateFaces(TArray<FFace>& OutFaces, const FIntVector& Plane, const FIntVector& Axis, const FIntVector& ModelSize, const bool SeparateModels, const uint32 ModelId) const;
-	void WritePolygon(FRawMesh& OutRawMesh, const FIntVector& Axis, const FPolygon& Polygon, const bool OneMaterial, const bool SeparateModels, const uint32 ModelId) const;
+	void CreatePlane(FVoxPlaneMesh& OutPlane, const FIntVector& Plane, const FIntVector& Axis, const FVoxVolume& Volume) const;
+	void CreatePolygons(TArray<FPolygon>& OutPolygons, const FIntVector& Plane, const FIntVector& Axis, const FVoxVolume& Volume) const;
+	void CreateFaces(TArray<FFace>& OutFaces, const FIntVector& Plane, const FIntVector& Axis, const FVoxVolume& Volume) const;
 
-	static void WriteVertex(FRawMesh& OutRawMesh, TArray<int>& OutLeftIndex, TArray<int>& OutRightIndex, const FIntVector& Axis, const FPolygon& Polygon);
-	static void WriteWedge(FRawMesh& OutRawMesh, bool Face, int Index1, int Index2, int Index3, int ColorIndex, const bool OneMaterial, const TArray<uint8>& Palette);
+	static void WritePolygon(FVoxPlaneMesh& OutPlane, const FIntVector& Axis, const FPolygon& Polygon);
+	static void WriteVertex(FVoxPlaneMesh& OutPlane, TArray<int>& OutLeftIndex, TArray<int>& OutRightIndex, const FIntVector& Axis, const FPolygon& Polygon);
+	static void WriteWedge(FVoxPlaneMesh& OutPlane, bool Face, int Index1, int Index2, int Index3, int ColorIndex);
 
 private:
 
@@ -35,7 +35,7 @@ FString NameFormater::GetPattern(const EFormaterObjectType& Type, const EVoxNami
 {
     const UDataTable* Table = GetNamingTable();
     if (!Table)
-        return "{BaseName}";
+        return GetDefaultPattern(Type, Convention);
     
     FString TypeStr;
     switch (Type)
@@ -45,6 +45,7 @@ FString NameFormater::GetPattern(const EFormaterObjectType& Type, const EVoxNami
         case EFormaterObjectType::Texture:           TypeStr = TEXT("Texture"); break;
         case EFormaterObjectType::StaticMesh:        TypeStr = TEXT("StaticMesh"); break;
         case EFormaterObjectType::Voxel:             TypeStr = TEXT("Voxel"); break;
+        case EFormaterObjectType::Blueprint:         TypeStr = TEXT("Blueprint"); break;
     }
 
     FString ConvStr;
@@ -59,12 +60,28 @@ FString NameFormater::GetPattern(const EFormaterObjectType& Type, const EVoxNami
     if (!Row)
     {
         UE_LOG(VoxNameFormater, Warning, TEXT("NameFormater: row '%s' not found"), *RowNameStr);
-        return "{BaseName}";
+        return GetDefaultPattern(Type, Convention);
     }
     
     return Row->Pattern;
 }
 
+FString NameFormater::GetDefaultPattern(const EFormaterObjectType& Type, const EVoxNamingConvention& Convention)
+{
+    // Mirrors Resources/NamingFormats.csv, keeps asset names distinct when the table is missing a row
+    const bool bUnrealEngine = Convention == EVoxNamingConvention::UnrealEngine;
+    switch (Type)
+    {
+        case EFormaterObjectType::Material:          return bUnrealEngine ? TEXT("M_{BaseName}") : TEXT("{BaseName}_MT");
+        case EFormaterObjectType::MaterialInstance:  return bUnrealEngine ? TEXT("MI_{BaseName}{_Color}") : TEXT("{BaseName}_MI{_Color}");
+        case EFormaterObjectType::Texture:           return bUnrealEngine ? TEXT("T_{BaseName}_{Description}") : TEXT("{BaseName}{Description}_TX");
+        case EFormaterObjectType::StaticMesh:        return bUnrealEngine ? TEXT("SM_{BaseName}{_Color}{_ModelId}") : TEXT("{BaseName}{_Color}{_ModelId}");
+        case EFormaterObjectType::Voxel:             return bUnrealEngine ? TEXT("V_{BaseName}{ModelId}") : TEXT("{BaseName}{_ModelId}");
+        case EFormaterObjectType::Blueprint:         return bUnrealEngine ? TEXT("BP_{BaseName}{_ModelId}") : TEXT("{BaseName}{_ModelId}_BP");
+    }
+    return "{BaseName}";
+}
+
 FString NameFormater::ApplyPattern(const FString& Pattern, const NameFormatArgs& Args)
 {
     FString Result = Pattern;
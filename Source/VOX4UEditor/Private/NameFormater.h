@@ -13,7 +13,8 @@ enum class EFormaterObjectType : uint8
     MaterialInstance,
     Texture,
     StaticMesh,
-    Voxel
+    Voxel,
+    Blueprint
 };
 
 struct NameFormatArgs
@@ -38,6 +39,8 @@ private:
 
     static FString GetPattern(const EFormaterObjectType& Type, const EVoxNamingConvention& Convention);
 
+    static FString GetDefaultPattern(const EFormaterObjectType& Type, const EVoxNamingConvention& Convention);
+
     static FString ApplyPattern(const FString& Pattern, const NameFormatArgs& Args);
 
 private:
@@ -7,6 +7,7 @@
 #include <Widgets/Input/SButton.h>
 #include <Widgets/Layout/SBox.h>
 #include <Widgets/Layout/SUniformGridPanel.h>
+#include <Widgets/Text/STextBlock.h>
 #include "VoxImportOption.h"
 
 SVoxOptionWidget::SVoxOptionWidget()
@@ -23,6 +24,10 @@ void SVoxOptionWidget::Construct(const FArguments& InArgs)
 
 	this->ChildSlot[
 		SNew(SVerticalBox)
+		+ SVerticalBox::Slot().AutoHeight().Padding(4) [
+			SNew(STextBlock).Text(InArgs._Summary).AutoWrapText(true)
+			.Visibility(InArgs._Summary.IsEmpty() ? EVisibility::Collapsed : EVisibility::Visible)
+		]
 		+ SVerticalBox::Slot().AutoHeight().Padding(2) [
 			SAssignNew(InspectorBox, SBox).MaxDesiredHeight(650.0f).WidthOverride(400.0f)
 		]
@@ -18,6 +18,7 @@ class SVoxOptionWidget : public SCompoundWidget
 		, _ImportOption(nullptr) { }
 		SLATE_ARGUMENT(TSharedPtr<SWindow>, Window)
 		SLATE_ARGUMENT(UVoxImportOption*, ImportOption)
+		SLATE_ARGUMENT(FText, Summary)
 	SLATE_END_ARGS()
 
 public:
@@ -0,0 +1,161 @@
+// Copyright (c) 2025 Muppetsg2
+// Licensed under the MIT License.
+
+#include <CoreMinimal.h>
+#include <Misc/AutomationTest.h>
+#include <MeshDescription.h>
+#include "Vox.h"
+#include "VoxImportOption.h"
+#include "VoxMeshBuilder.h"
+#include "VoxVolume.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace VoxMeshBenchmark
+{
+	/** Models of the fixture, stacked along Z so merging them overlaps nothing */
+	static const int32 NumModels = 4;
+	/** Edge length of every model */
+	static const int32 ModelSize = 48;
+	/** Merged meshing may cost at most this many times the separate time per voxel */
+	static const double MaxRatio = 2.0;
+	/** Runs of each mode, the fastest one is compared */
+	static const int32 NumRuns = 3;
+
+	static void AppendInt(TArray<uint8>& Out, int32 Value)
+	{
+		const uint8 Bytes[4] = { (uint8)Value, (uint8)(Value >> 8), (uint8)(Value >> 16), (uint8)(Value >> 24) };
+		Out.Append(Bytes, 4);
+	}
+
+	static void AppendChunk(TArray<uint8>& Out, const ANSICHAR* Id, const TArray<uint8>& Contents)
+	{
+		Out.Append((const uint8*)Id, 4);
+		AppendInt(Out, Contents.Num());
+		AppendInt(Out, 0);
+		Out.Append(Contents);
+	}
+
+	/**
+	 * Vox file of models filling their own band of Z with a deterministic pattern of holes and colors
+	 * @param OutBuffer Out file contents
+	 */
+	static void CreateFixture(TArray<uint8>& OutBuffer)
+	{
+		TArray<uint8> Children;
+		const int32 Band = ModelSize / NumModels;
+		for (int32 ModelId = 0; ModelId < NumModels; ++ModelId)
+		{
+			TArray<uint8> Size;
+			AppendInt(Size, ModelSize);
+			AppendInt(Size, ModelSize);
+			AppendInt(Size, ModelSize);
+			AppendChunk(Children, "SIZE", Size);
+
+			TArray<uint8> Cells;
+			for (int32 Z = ModelId * Band; Z < (ModelId + 1) * Band; ++Z)
+			{
+				for (int32 Y = 0; Y < ModelSize; ++Y)
+				{
+					for (int32 X = 0; X < ModelSize; ++X)
+					{
+						const uint32 Hash = (uint32)(X * 73856093) ^ (uint32)(Y * 19349663) ^ (uint32)(Z * 83492791);
+						if (Hash % 5 != 0)
+						{
+							const uint8 Cell[4] = { (uint8)X, (uint8)Y, (uint8)Z, (uint8)(1 + (Hash >> 8) % 16) };
+							Cells.Append(Cell, 4);
+						}
+					}
+				}
+			}
+			TArray<uint8> Voxels;
+			AppendInt(Voxels, Cells.Num() / 4);
+			Voxels.Append(Cells);
+			AppendChunk(Children, "XYZI", Voxels);
+		}
+
+		OutBuffer.Reset();
+		OutBuffer.Append((const uint8*)"VOX ", 4);
+		AppendInt(OutBuffer, 150);
+		OutBuffer.Append((const uint8*)"MAIN", 4);
+		AppendInt(OutBuffer, 0);
+		AppendInt(OutBuffer, Children.Num());
+		OutBuffer.Append(Children);
+	}
+
+	/**
+	 * Mesh every volume of the import the way the factory does, and time it
+	 * @param OutSeconds Out fastest meshing time of all runs
+	 * @param OutNumVoxels Out meshed voxels of one run
+	 * @return bool every volume produced triangles
+	 */
+	static bool MeshImport(double& OutSeconds, int32& OutNumVoxels, const FVox& Vox, const UVoxImportOption* ImportOption)
+	{
+		const uint32 NumVolumes = ImportOption->bSeparateModels ? (uint32)Vox.Models.Num() : 1;
+		OutSeconds = DBL_MAX;
+		bool bMeshed = true;
+		for (int32 Run = 0; Run < NumRuns; ++Run)
+		{
+			OutNumVoxels = 0;
+			const double StartTime = FPlatformTime::Seconds();
+			for (uint32 ModelId = 0; ModelId < NumVolumes; ++ModelId)
+			{
+				FVoxVolume Volume;
+				Vox.CreateVolume(Volume, ImportOption, ModelId);
+				FVoxMaterialSlots MaterialSlots;
+				FVoxMeshBuilder::CreateMaterialSlots(MaterialSlots, &Vox, ImportOption, ModelId);
+				FMeshDescription MeshDescription;
+				bMeshed &= Vox.CreateOptimizedMeshDescription(MeshDescription, Volume, MaterialSlots, Vox.GetMeshOffset(ImportOption, ModelId), ImportOption);
+				bMeshed &= 0 < MeshDescription.Triangles().Num();
+				OutNumVoxels += Volume.NumVoxels;
+			}
+			OutSeconds = FMath::Min(OutSeconds, FPlatformTime::Seconds() - StartTime);
+		}
+		return bMeshed;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVoxMergedMeshingBenchmarkTest, "VOX4U.Import.MergedMeshingPerVoxel", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+/**
+ * Merged and separate imports of the same file mesh the same voxels
+ * Merged meshing reads one shared volume, so its time per voxel stays close to the separate one
+ */
+bool FVoxMergedMeshingBenchmarkTest::RunTest(const FString& Parameters)
+{
+	using namespace VoxMeshBenchmark;
+
+	TArray<uint8> Buffer;
+	CreateFixture(Buffer);
+
+	for (const EVoxMeshingAlgorithm MeshingAlgorithm : { EVoxMeshingAlgorithm::Monotone, EVoxMeshingAlgorithm::Greedy })
+	{
+		const FString AlgorithmName = UEnum::GetDisplayValueAsText(MeshingAlgorithm).ToString();
+		double Seconds[2] = { 0.0, 0.0 };
+		int32 NumVoxels[2] = { 0, 0 };
+		for (int32 Mode = 0; Mode < 2; ++Mode)
+		{
+			UVoxImportOption* ImportOption = NewObject<UVoxImportOption>();
+			ImportOption->bSeparateModels = Mode == 1;
+			ImportOption->MeshingAlgorithm = MeshingAlgorithm;
+
+			FVox Vox(TEXT("MergedMeshingBenchmark.vox"), Buffer.GetData(), Buffer.GetData() + Buffer.Num(), ImportOption);
+			if (!TestEqual(TEXT("Fixture models"), Vox.Models.Num(), NumModels))
+			{
+				return false;
+			}
+			TestTrue(FString::Printf(TEXT("%s %s import is meshed"), *AlgorithmName, Mode == 1 ? TEXT("separate") : TEXT("merged")), MeshImport(Seconds[Mode], NumVoxels[Mode], Vox, ImportOption));
+		}
+
+		TestEqual(FString::Printf(TEXT("%s merged and separate voxels"), *AlgorithmName), NumVoxels[0], NumVoxels[1]);
+		const double MergedPerVoxel = Seconds[0] * 1000000.0 / FMath::Max(NumVoxels[0], 1);
+		const double SeparatePerVoxel = Seconds[1] * 1000000.0 / FMath::Max(NumVoxels[1], 1);
+		const double Ratio = MergedPerVoxel / FMath::Max(SeparatePerVoxel, UE_DOUBLE_SMALL_NUMBER);
+		AddInfo(FString::Printf(TEXT("%s: %d voxels, merged %.3f us per voxel, separate %.3f us per voxel, ratio %.2f"),
+			*AlgorithmName, NumVoxels[0], MergedPerVoxel, SeparatePerVoxel, Ratio));
+		TestTrue(FString::Printf(TEXT("%s merged time per voxel within %.1fx of separate"), *AlgorithmName, MaxRatio), Ratio <= MaxRatio);
+	}
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -2,12 +2,255 @@
 // Edited by Muppetsg2 2025
 
 #include "Vox.h"
+#include <Async/ParallelFor.h>
 #include <Engine/Texture2D.h>
+#include <StaticMeshAttributes.h>
+#include "GreedyMesh.h"
 #include "MonotoneMesh.h"
 #include "VoxImportOption.h"
+#include "VoxMeshBuilder.h"
+#include "VoxReader.h"
+#include "VoxVolume.h"
+#include "VoxWorld.h"
 
 DEFINE_LOG_CATEGORY_STATIC(LogVox, Log, All)
 
+/** Log every voxel and palette entry while parsing, far too slow for large models */
+#ifndef VOX4U_LOG_VOXELS
+#define VOX4U_LOG_VOXELS 0
+#endif
+
+/**
+ * Remap packed XYZI words from MagicaVoxel to engine axes in place, four voxels per vector
+ * X forward: X = Size.X - Y - 1, Y = Size.Y - X - 1. Otherwise X = Size.X - X - 1
+ * Results wrap to 8 bits like the cell format, Z and I are kept
+ * @param Words Little endian X | Y << 8 | Z << 16 | I << 24 words
+ * @param NumWords Number of words
+ * @param Size Model size in engine axes
+ * @param bXForward Swap X and Y axes
+ */
+static void RemapVoxelWords(uint32* Words, const int32 NumWords, const FIntVector& Size, const bool bXForward)
+{
+	const int32 LastX = Size.X - 1;
+	const int32 LastY = Size.Y - 1;
+	const int32 NumVectorWords = NumWords & ~3;
+
+	const VectorRegister4Int ByteMask = MakeVectorRegisterInt(0xFF, 0xFF, 0xFF, 0xFF);
+	const VectorRegister4Int LastXVector = MakeVectorRegisterInt(LastX, LastX, LastX, LastX);
+	const VectorRegister4Int LastYVector = MakeVectorRegisterInt(LastY, LastY, LastY, LastY);
+	if (bXForward)
+	{
+		const VectorRegister4Int KeepMask = MakeVectorRegisterInt((int32)0xFFFF0000, (int32)0xFFFF0000, (int32)0xFFFF0000, (int32)0xFFFF0000);
+		for (int32 i = 0; i < NumVectorWords; i += 4)
+		{
+			const VectorRegister4Int Word = VectorIntLoad(&Words[i]);
+			const VectorRegister4Int X = VectorIntAnd(Word, ByteMask);
+			const VectorRegister4Int Y = VectorIntAnd(VectorShiftRightImmLogical(Word, 8), ByteMask);
+			const VectorRegister4Int NewX = VectorIntAnd(VectorIntSubtract(LastXVector, Y), ByteMask);
+			const VectorRegister4Int NewY = VectorIntAnd(VectorIntSubtract(LastYVector, X), ByteMask);
+			VectorIntStore(VectorIntOr(VectorIntAnd(Word, KeepMask), VectorIntOr(NewX, VectorShiftLeftImm(NewY, 8))), &Words[i]);
+		}
+		for (int32 i = NumVectorWords; i < NumWords; ++i)
+		{
+			const uint32 Word = Words[i];
+			const uint32 NewX = (uint32)(LastX - (int32)((Word >> 8) & 0xFF)) & 0xFF;
+			const uint32 NewY = (uint32)(LastY - (int32)(Word & 0xFF)) & 0xFF;
+			Words[i] = (Word & 0xFFFF0000) | NewX | (NewY << 8);
+		}
+	}
+	else
+	{
+		const VectorRegister4Int KeepMask = MakeVectorRegisterInt((int32)0xFFFFFF00, (int32)0xFFFFFF00, (int32)0xFFFFFF00, (int32)0xFFFFFF00);
+		for (int32 i = 0; i < NumVectorWords; i += 4)
+		{
+			const VectorRegister4Int Word = VectorIntLoad(&Words[i]);
+			const VectorRegister4Int NewX = VectorIntAnd(VectorIntSubtract(LastXVector, VectorIntAnd(Word, ByteMask)), ByteMask);
+			VectorIntStore(VectorIntOr(VectorIntAnd(Word, KeepMask), NewX), &Words[i]);
+		}
+		for (int32 i = NumVectorWords; i < NumWords; ++i)
+		{
+			const uint32 Word = Words[i];
+			Words[i] = (Word & 0xFFFFFF00) | ((uint32)(LastX - (int32)(Word & 0xFF)) & 0xFF);
+		}
+	}
+}
+
+/**
+ * Decode XYZI chunk into model
+ * @param Model Model to write
+ * @param Contents Chunk contents
+ * @param Size Model size, already remapped
+ * @param ImportOption Import option, null keeps file axes
+ */
+static void ReadVoxelChunk(FVoxModelData& Model, FVoxReader Contents, const FIntVector& Size, const UVoxImportOption* ImportOption)
+{
+	uint32 NumVoxels = 0;
+	Contents.Read(NumVoxels);
+	UE_LOG(LogVox, Verbose, TEXT("XYZI: NumVoxels=%d"), NumVoxels);
+	NumVoxels = (uint32)FMath::Min<int64>(NumVoxels, Contents.Remaining() / 4);
+	const uint8* Cells = Contents.ReadSpan((int64)NumVoxels * 4);
+	if (!Cells)
+	{
+		return;
+	}
+
+	TArray<uint32> Words;
+	Words.SetNumUninitialized(NumVoxels);
+	FMemory::Memcpy(Words.GetData(), Cells, (SIZE_T)NumVoxels * 4);
+#if !PLATFORM_LITTLE_ENDIAN
+	for (uint32& Word : Words)
+	{
+		Word = BYTESWAP_ORDER32(Word);
+	}
+#endif
+	if (ImportOption)
+	{
+		RemapVoxelWords(Words.GetData(), Words.Num(), Size, ImportOption->bImportXForward);
+	}
+
+	for (const uint32 Word : Words)
+	{
+		const FIntVector Position(Word & 0xFF, (Word >> 8) & 0xFF, (Word >> 16) & 0xFF);
+		const uint8 I = (uint8)(Word >> 24);
+#if VOX4U_LOG_VOXELS
+		UE_LOG(LogVox, Verbose, TEXT("      Voxel X=%d Y=%d Z=%d I=%d"), Position.X, Position.Y, Position.Z, I);
+#endif
+		Model.Set(Position, I);
+	}
+}
+
+/**
+ * Decode RGBA chunk into palette
+ * Palette entry i holds color index i + 1, the last entry is unused
+ * @param Palette Palette to append
+ * @param Contents Chunk contents
+ */
+static void ReadPaletteChunk(TArray<FColor>& Palette, FVoxReader Contents)
+{
+	UE_LOG(LogVox, Verbose, TEXT("RGBA:"));
+	const int64 NumColors = Contents.Remaining() / 4;
+	const uint8* Colors = Contents.ReadSpan(NumColors * 4);
+	Palette.Add(FColor(0, 0, 0, 0));
+	for (int64 i = 1; Colors && i < NumColors; ++i)
+	{
+		const uint8* Entry = Colors + (i - 1) * 4;
+		FColor Color(Entry[0], Entry[1], Entry[2], Entry[3]);
+#if VOX4U_LOG_VOXELS
+		UE_LOG(LogVox, Verbose, TEXT("      %s"), *Color.ToString());
+#endif
+		Palette.Add(Color);
+	}
+}
+
+/**
+ * Decode MATL chunk into material table
+ * @param Materials Materials indexed by id
+ * @param Contents Chunk contents
+ */
+static void ReadMaterialChunk(TArray<FVoxMaterial>& Materials, FVoxReader Contents)
+{
+	UE_LOG(LogVox, Verbose, TEXT("MATL:"));
+
+	int32 MaterialId;
+	Contents.Read(MaterialId);
+
+	if (MaterialId < 0 || 255 < MaterialId)
+	{
+		return;
+	}
+
+	FVoxMaterial& Material = Materials[MaterialId];
+
+	TMap<FString, FString> MatDict;
+	Contents.ReadDict(MatDict);
+
+	bool IORChecked = false;
+	bool TransChecked = false;
+
+	UE_LOG(LogVox, Verbose, TEXT("Material[%i]:"), MaterialId);
+	for (const auto& Pair : MatDict)
+	{
+		const FString& Key = Pair.Key;
+		const FString& Value = Pair.Value;
+
+		if (TEXT("_type") == Key)
+		{
+			if (TEXT("_diffuse") == Value)
+			{
+				Material.Type = EVoxMaterialType::DIFFUSE;
+			}
+			else if (TEXT("_metal") == Value)
+			{
+				Material.Type = EVoxMaterialType::METAL;
+			}
+			else if (TEXT("_glass") == Value)
+			{
+				Material.Type = EVoxMaterialType::GLASS;
+			}
+			else if (TEXT("_emit") == Value)
+			{
+				Material.Type = EVoxMaterialType::EMIT;
+			}
+		}
+		else if (TEXT("_weight") == Key)
+		{
+			Material.Weight = static_cast<float>(FCString::Atof(*Value));
+		}
+		else if (TEXT("_rough") == Key)
+		{
+			Material.Roughness = static_cast<float>(FCString::Atof(*Value));
+		}
+		else if (TEXT("_metal") == Key)
+		{
+			Material.Metallic = static_cast<float>(FCString::Atof(*Value));
+		}
+		else if (TEXT("_spec") == Key || TEXT("_sp") == Key)
+		{
+			Material.Specular = static_cast<float>(FCString::Atof(*Value));
+		}
+		else if (TEXT("_ior") == Key && !IORChecked)
+		{
+			Material.IOR = static_cast<float>(FCString::Atof(*Value));
+			IORChecked = true;
+		}
+		else if (TEXT("_ri") == Key && !IORChecked)
+		{
+			Material.IOR = static_cast<float>(FCString::Atof(*Value)) - 1.0f;
+			IORChecked = true;
+		}
+		else if (TEXT("_att") == Key)
+		{
+			Material.Att = static_cast<float>(FCString::Atof(*Value));
+		}
+		else if (TEXT("_emit") == Key)
+		{
+			Material.Emissive = static_cast<float>(FCString::Atof(*Value));
+		}
+		else if (TEXT("_flux") == Key)
+		{
+			Material.EmissionPower = static_cast<float>(FCString::Atof(*Value));
+		}
+		else if (TEXT("_ldr") == Key)
+		{
+			Material.LDR = static_cast<float>(FCString::Atof(*Value));
+		}
+		else if (TEXT("_trans") == Key && !TransChecked)
+		{
+			Material.Transparency = static_cast<float>(FCString::Atof(*Value));
+			TransChecked = true;
+		}
+		else if (TEXT("_alpha") == Key && !TransChecked)
+		{
+			Material.Transparency = static_cast<float>(FCString::Atof(*Value));
+			TransChecked = true;
+		}
+		else if (TEXT("_plastic") == Key)
+		{
+			Material.Plastic = (0 != FCString::Atoi(*Value));
+		}
+	}
+}
+
 /**
  * MagicaVoxel default palette
  */
@@ -46,6 +289,220 @@ static const uint32 MagicaVoxelDefaultPalette[256] = {
 	0xffbbbbbb, 0xffaaaaaa, 0xff888888, 0xff777777, 0xff555555, 0xff444444, 0xff222222, 0xff111111
 };
 
+/**
+ * Read node id and attributes common to scene graph chunks
+ * @param Nodes Scene graph nodes
+ * @param Contents Chunk contents
+ * @param Type Node kind
+ * @return FVoxSceneNode& Node read, hidden when the _hidden attribute is set
+ */
+static FVoxSceneNode& ReadSceneNode(TMap<int32, FVoxSceneNode>& Nodes, FVoxReader& Contents, const EVoxSceneNodeType Type)
+{
+	int32 NodeId = 0;
+	Contents.Read(NodeId);
+	TMap<FString, FString> Attributes;
+	Contents.ReadDict(Attributes);
+
+	FVoxSceneNode& Node = Nodes.Add(NodeId);
+	Node.Type = Type;
+	const FString* Hidden = Attributes.Find(TEXT("_hidden"));
+	Node.bHidden = Hidden && *Hidden == TEXT("1");
+	UE_LOG(LogVox, Verbose, TEXT("      Node %d"), NodeId);
+	return Node;
+}
+
+/**
+ * Decode nTRN, nGRP or nSHP chunk into scene graph
+ * @param Nodes Scene graph nodes
+ * @param Contents Chunk contents
+ * @param ChunkId Chunk id
+ */
+static void ReadSceneChunk(TMap<int32, FVoxSceneNode>& Nodes, FVoxReader Contents, const ANSICHAR* ChunkId)
+{
+	if (0 == FCStringAnsi::Strncmp("nTRN", ChunkId, 4))
+	{
+		UE_LOG(LogVox, Verbose, TEXT("nTRN:"));
+		FVoxSceneNode& Node = ReadSceneNode(Nodes, Contents, EVoxSceneNodeType::Transform);
+		int32 ChildId = 0, ReservedId = 0, LayerId = 0, NumFrames = 0;
+		Contents.Read(ChildId);
+		Contents.Read(ReservedId);
+		Contents.Read(LayerId);
+		Contents.Read(NumFrames);
+		Node.Children.Add(ChildId);
+		if (0 < NumFrames)
+		{
+			TMap<FString, FString> Frame;
+			Contents.ReadDict(Frame);
+			if (const FString* Rotation = Frame.Find(TEXT("_r")))
+			{
+				Node.Rotation = (uint8)FCString::Atoi(**Rotation);
+			}
+			if (const FString* Translation = Frame.Find(TEXT("_t")))
+			{
+				TArray<FString> Values;
+				Translation->ParseIntoArrayWS(Values);
+				for (int32 i = 0; i < FMath::Min(Values.Num(), 3); ++i)
+				{
+					Node.Translation[i] = FCString::Atoi(*Values[i]);
+				}
+			}
+		}
+	}
+	else if (0 == FCStringAnsi::Strncmp("nGRP", ChunkId, 4))
+	{
+		UE_LOG(LogVox, Verbose, TEXT("nGRP:"));
+		FVoxSceneNode& Node = ReadSceneNode(Nodes, Contents, EVoxSceneNodeType::Group);
+		int32 NumChildren = 0;
+		Contents.Read(NumChildren);
+		for (int32 i = 0; i < NumChildren && !Contents.IsError(); ++i)
+		{
+			Contents.Read(Node.Children.AddDefaulted_GetRef());
+		}
+	}
+	else
+	{
+		UE_LOG(LogVox, Verbose, TEXT("nSHP:"));
+		FVoxSceneNode& Node = ReadSceneNode(Nodes, Contents, EVoxSceneNodeType::Shape);
+		int32 NumModels = 0;
+		Contents.Read(NumModels);
+		for (int32 i = 0; i < NumModels && !Contents.IsError(); ++i)
+		{
+			Contents.Read(Node.Children.AddDefaulted_GetRef());
+			TMap<FString, FString> Attributes;
+			Contents.ReadDict(Attributes);
+		}
+	}
+}
+
+/**
+ * Create empty model
+ */
+FVoxModelData::FVoxModelData()
+	: Size(FIntVector::ZeroValue)
+	, Colors()
+	, Occupancy()
+	, BoundsMin(FIntVector::ZeroValue)
+	, BoundsMax(FIntVector::ZeroValue)
+	, NumVoxels(0)
+{
+	FMemory::Memzero(Histogram);
+	FMemory::Memzero(UsedColors);
+}
+
+/**
+ * Allocate empty grid
+ * @param InSize Model size
+ */
+void FVoxModelData::Init(const FIntVector& InSize)
+{
+	Size = FIntVector(FMath::Clamp(InSize.X, 0, 256), FMath::Clamp(InSize.Y, 0, 256), FMath::Clamp(InSize.Z, 0, 256));
+	const int32 NumCells = Size.X * Size.Y * Size.Z;
+	Colors.Init(0, NumCells);
+	Occupancy.Init(false, NumCells);
+	NumVoxels = 0;
+}
+
+/**
+ * Write voxel color, later writes replace earlier ones
+ * @param Position Cell position
+ * @param Color Color index, zero clears the cell
+ */
+void FVoxModelData::Set(const FIntVector& Position, uint8 Color)
+{
+	if (!IsInside(Position))
+	{
+		return;
+	}
+	const int32 Index = GetIndex(Position);
+	NumVoxels += (Occupancy[Index] ? -1 : 0) + (Color == 0 ? 0 : 1);
+	Occupancy[Index] = Color != 0;
+	Colors[Index] = Color;
+}
+
+/**
+ * Compute statistics of occupied cells in one pass
+ * Readers use them instead of rescanning the grid
+ */
+void FVoxModelData::UpdateStatistics()
+{
+	FMemory::Memzero(Histogram);
+	FMemory::Memzero(UsedColors);
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		SliceVoxels[Axis].Init(0, Size[Axis]);
+	}
+	BoundsMin = Size;
+	BoundsMax = FIntVector::ZeroValue;
+	for (FConstIterator It = CreateConstIterator(); It; ++It)
+	{
+		const FIntVector Position = It.GetPosition();
+		const uint8 Color = It.GetColor();
+		++Histogram[Color];
+		UsedColors[Color / 64] |= uint64(1) << (Color % 64);
+		++SliceVoxels[0][Position.X];
+		++SliceVoxels[1][Position.Y];
+		++SliceVoxels[2][Position.Z];
+		BoundsMin = FIntVector(FMath::Min(BoundsMin.X, Position.X), FMath::Min(BoundsMin.Y, Position.Y), FMath::Min(BoundsMin.Z, Position.Z));
+		BoundsMax = FIntVector(FMath::Max(BoundsMax.X, Position.X + 1), FMath::Max(BoundsMax.Y, Position.Y + 1), FMath::Max(BoundsMax.Z, Position.Z + 1));
+	}
+	if (NumVoxels == 0)
+	{
+		BoundsMin = BoundsMax = FIntVector::ZeroValue;
+	}
+}
+
+/**
+ * Remap grid from file axes to engine axes, matches the remap applied while decoding
+ * X forward swaps and mirrors X and Y, otherwise X is mirrored
+ * @param bXForward Import X forward
+ */
+void FVoxModelData::Remap(const bool bXForward)
+{
+	if (NumVoxels == 0)
+	{
+		if (bXForward)
+		{
+			Swap(Size.X, Size.Y);
+		}
+		return;
+	}
+
+	const FIntVector FileSize = Size;
+	const TArray<uint8> FileColors = MoveTemp(Colors);
+	Init(bXForward ? FIntVector(FileSize.Y, FileSize.X, FileSize.Z) : FileSize);
+	for (int32 Z = 0; Z < Size.Z; ++Z)
+	{
+		for (int32 Y = 0; Y < Size.Y; ++Y)
+		{
+			for (int32 X = 0; X < Size.X; ++X)
+			{
+				const FIntVector FilePosition = bXForward ? FIntVector(Size.Y - 1 - Y, Size.X - 1 - X, Z) : FIntVector(Size.X - 1 - X, Y, Z);
+				const uint8 Color = FileColors[(FilePosition.Z * FileSize.Y + FilePosition.Y) * FileSize.X + FilePosition.X];
+				if (Color)
+				{
+					const int32 Index = GetIndex(FIntVector(X, Y, Z));
+					Colors[Index] = Color;
+					Occupancy[Index] = true;
+					++NumVoxels;
+				}
+			}
+		}
+	}
+	UpdateStatistics();
+}
+
+/**
+ * Free the grid of a meshed model
+ * Histogram, used colors and bounds stay valid for palette and material lookups
+ */
+void FVoxModelData::Release()
+{
+	Size = FIntVector::ZeroValue;
+	Colors.Empty();
+	Occupancy.Empty();
+	NumVoxels = 0;
+}
+
 /**
  * Create empty vox data.
  */
@@ -61,14 +518,45 @@ FVox::FVox(const FString& Filename, FArchive& Ar, const UVoxImportOption* Import
 	Import(Ar, ImportOption);
 }
 
+/**
+ * Create vox data from memory
+ * @param Buffer First byte of vox file
+ * @param BufferEnd Byte past the end of vox file
+ */
+FVox::FVox(const FString& Filename, const uint8* Buffer, const uint8* BufferEnd, const UVoxImportOption* ImportOption)
+{
+	this->Filename = Filename;
+	Import(Buffer, BufferEnd, ImportOption);
+}
+
 /**
  * Import vox data from archive
+ * Loads the remaining archive with one read and parses it in memory
  * @param FArchive& Ar - Read vox data from the archive
  * @return bool	is valid or supported vox data
  */
 bool FVox::Import(FArchive& Ar, const UVoxImportOption* ImportOption)
 {
-	Ar.Serialize(MagicNumber, 4);
+	TArray<uint8> Buffer;
+	Buffer.SetNumUninitialized(FMath::Max<int64>(Ar.TotalSize() - Ar.Tell(), 0));
+	Ar.Serialize(Buffer.GetData(), Buffer.Num());
+	return Import(Buffer.GetData(), Buffer.GetData() + Buffer.Num(), ImportOption);
+}
+
+/**
+ * Walk chunk headers of vox file, payloads are skipped with a single offset bump each
+ * Only SIZE, PACK and the small scene graph chunks are read, XYZI, RGBA and MATL contents are kept as spans
+ * @param Buffer First byte of vox file, must outlive the directory
+ * @param BufferEnd Byte past the end of vox file
+ * @return bool is valid or supported vox data
+ */
+bool FVoxDirectory::Read(const uint8* Buffer, const uint8* BufferEnd)
+{
+	*this = FVoxDirectory();
+
+	FVoxReader Reader(Buffer, BufferEnd - Buffer);
+	ANSICHAR MagicNumber[5] = { 0, };
+	Reader.Read(MagicNumber, 4);
 
 	if (0 != FCStringAnsi::Strncmp("VOX ", MagicNumber, 4))
 	{
@@ -78,7 +566,7 @@ bool FVox::Import(FArchive& Ar, const UVoxImportOption* ImportOption)
 	FString MagicString = FString(4, UTF8_TO_TCHAR(MagicNumber));
 	UE_LOG(LogVox, Verbose, TEXT("MAGIC NUMBER: %s"), *MagicString);
 
-	Ar << VersionNumber;
+	Reader.Read(VersionNumber);
 	UE_LOG(LogVox, Verbose, TEXT("VERSION NUMBER: %d"), VersionNumber);
 
 	if (200 < VersionNumber)
@@ -87,231 +575,235 @@ bool FVox::Import(FArchive& Ar, const UVoxImportOption* ImportOption)
 		return false;
 	}
 
-	/* Read Helpers */
-	auto ReadString = [&](FArchive& A) -> FString {
-		uint32 StringSize = 0;
-		Ar << StringSize;
-		if (StringSize <= 0) return FString();
-		ANSICHAR* Buffer = (ANSICHAR*)FMemory::Malloc(StringSize + 1);
-		Ar.Serialize(Buffer, StringSize);
-		FString Out = FString(StringSize, UTF8_TO_TCHAR(Buffer));
-		FMemory::Free(Buffer);
-		return Out;
-	};
-
-	auto ReadDict = [&](FArchive& A) -> TMap<FString, FString> {
-		uint32 NumPairs = 0;
-		A << NumPairs;
-		TMap<FString, FString> Dict;
-		for (uint32 i = 0; i < NumPairs; ++i)
-		{
-			FString Key = ReadString(A);
-			FString Value = ReadString(A);
-			Dict.Add(Key, Value);
-		}
-		return Dict;
-	};
-
-	auto SkipBytes = [&](FArchive& A, uint32 NumOfBytes) -> void {
-		uint8 byte;
-		for (uint32 i = 0; i < NumOfBytes; ++i)
-		{
-			A << byte;
-		}
-	};
-
 	ANSICHAR ChunkId[5] = { 0, };
 	uint32 SizeOfChunkContents;
 	uint32 TotalSizeOfChildrenChunks;
-	uint32 CurrentModelId = 0;
-	FIntVector Size = FIntVector::ZeroValue;
+	while (!Reader.AtEnd())
+	{
+		Reader.Read(ChunkId, 4);
+		Reader.Read(SizeOfChunkContents);
+		Reader.Read(TotalSizeOfChildrenChunks);
+		FVoxReader Contents = Reader.ReadReader(SizeOfChunkContents);
+		if (Reader.IsError())
+		{
+			UE_LOG(LogVox, Error, TEXT("Truncated chunk [ %s ]."), *FString(ChunkId));
+			return false;
+		}
 
-	Materials.Init(FVoxMaterial(), 256);
-	do {
-		Ar.Serialize(ChunkId, 4);
-		Ar << SizeOfChunkContents;
-		Ar << TotalSizeOfChildrenChunks;
 		if (0 == FCStringAnsi::Strncmp("MAIN", ChunkId, 4))
 		{
+			// Children of MAIN are the top level chunks that follow
 			UE_LOG(LogVox, Verbose, TEXT("MAIN:"));
-			SkipBytes(Ar, SizeOfChunkContents);
+			continue;
 		}
 		else if (0 == FCStringAnsi::Strncmp("PACK", ChunkId, 4))
 		{
 			UE_LOG(LogVox, Verbose, TEXT("PACK:"));
 			uint32 NumModels;
-			Ar << NumModels;
-			SkipBytes(Ar, 4 < SizeOfChunkContents ? SizeOfChunkContents - 4 : 0);
+			Contents.Read(NumModels);
 			UE_LOG(LogVox, Verbose, TEXT("      NumModels %d"), NumModels);
-			SkipBytes(Ar, TotalSizeOfChildrenChunks);
 		}
 		else if (0 == FCStringAnsi::Strncmp("SIZE", ChunkId, 4))
 		{
-			Ar << Size.X << Size.Y << Size.Z;
-			if (ImportOption->bImportXForward)
-			{
-				int32 temp = Size.X;
-				Size.X = Size.Y;
-				Size.Y = temp;
-			}
-			UE_LOG(LogVox, Verbose, TEXT("SIZE: %s"), *Size.ToString());
-			SkipBytes(Ar, TotalSizeOfChildrenChunks);
-
-			CurrentModelId = Sizes.Num();
-			Sizes.Add(Size);
-			Models.Add(FVoxModelData());
+			FVoxModelInfo& Model = Models.AddDefaulted_GetRef();
+			Contents.Read(Model.Size.X);
+			Contents.Read(Model.Size.Y);
+			Contents.Read(Model.Size.Z);
+			UE_LOG(LogVox, Verbose, TEXT("SIZE: %s"), *Model.Size.ToString());
 		}
 		else if (0 == FCStringAnsi::Strncmp("XYZI", ChunkId, 4))
 		{
-			uint32 NumVoxels;
-			Ar << NumVoxels;
-			UE_LOG(LogVox, Verbose, TEXT("XYZI: NumVoxels=%d"), NumVoxels);
-			uint8 X, Y, Z, I;
-			for (uint32 i = 0; i < NumVoxels; ++i)
+			if (Models.Num() == 0)
 			{
-				Ar << X << Y << Z << I;
-				if (ImportOption->bImportXForward)
-				{
-					uint8 temp = X;
-					X = Size.X - Y - 1;
-					Y = Size.Y - temp - 1;
-				}
-				else
-				{
-					X = Size.X - X - 1;
-				}
-				UE_LOG(LogVox, Verbose, TEXT("      Voxel X=%d Y=%d Z=%d I=%d"), X, Y, Z, I);
-				Models[CurrentModelId].Voxels.Add(FIntVector(X, Y, Z), I);
+				UE_LOG(LogVox, Warning, TEXT("XYZI chunk without model, skipped."));
+			}
+			else
+			{
+				FVoxReader Header = Contents;
+				uint32 NumVoxels = 0;
+				Header.Read(NumVoxels);
+				Models.Last().NumVoxels += (int32)FMath::Min<int64>(NumVoxels, Header.Remaining() / 4);
+				Models.Last().VoxelChunks.Add(Contents);
 			}
-			SkipBytes(Ar, TotalSizeOfChildrenChunks);
 		}
 		else if (0 == FCStringAnsi::Strncmp("RGBA", ChunkId, 4))
 		{
-			UE_LOG(LogVox, Verbose, TEXT("RGBA:"));
-			FColor Color;
-			Palette.Add(FColor(0, 0, 0, 0));
-			for (uint32 i = 1; i < SizeOfChunkContents / 4; ++i)
-			{
-				Ar << Color.R << Color.G << Color.B << Color.A;
-				UE_LOG(LogVox, Verbose, TEXT("      %s"), *Color.ToString());
-				Palette.Add(Color);
-			}
-			Ar << Color.R << Color.G << Color.B << Color.A;
-			SkipBytes(Ar, TotalSizeOfChildrenChunks);
+			PaletteChunks.Add(Contents);
 		}
 		else if (0 == FCStringAnsi::Strncmp("MATL", ChunkId, 4))
 		{
-			UE_LOG(LogVox, Verbose, TEXT("MATL:"));
-
-			int32 MaterialId;
-			Ar << MaterialId;
+			MaterialChunks.Add(Contents);
+		}
+		else if (0 == FCStringAnsi::Strncmp("nTRN", ChunkId, 4) || 0 == FCStringAnsi::Strncmp("nGRP", ChunkId, 4) || 0 == FCStringAnsi::Strncmp("nSHP", ChunkId, 4))
+		{
+			ReadSceneChunk(SceneNodes, Contents, ChunkId);
+		}
+		else
+		{
+			FString UnknownChunk(ChunkId);
+			UE_LOG(LogVox, Warning, TEXT("Unsupported chunk [ %s ]. Skipping %d byte of chunk contents. Skipped %d byte of chunk childrens."), *UnknownChunk, SizeOfChunkContents, TotalSizeOfChildrenChunks);
+		}
+		Reader.Skip(TotalSizeOfChildrenChunks);
+	}
+	UE_LOG(LogVox, Verbose, TEXT("Directory: %d models, %d palettes, %d materials, %d scene nodes"), Models.Num(), PaletteChunks.Num(), MaterialChunks.Num(), SceneNodes.Num());
+	return true;
+}
 
-			if (255 < MaterialId)
+/**
+ * Mark color indices used by each model and by any voxel, reads the color byte of every XYZI entry without decoding positions
+ */
+void FVoxDirectory::CountUsedColors()
+{
+	FMemory::Memzero(UsedColors);
+	for (FVoxModelInfo& Model : Models)
+	{
+		FMemory::Memzero(Model.UsedColors);
+		for (FVoxReader Contents : Model.VoxelChunks)
+		{
+			uint32 NumVoxels = 0;
+			Contents.Read(NumVoxels);
+			NumVoxels = (uint32)FMath::Min<int64>(NumVoxels, Contents.Remaining() / 4);
+			const uint8* Cells = Contents.ReadSpan((int64)NumVoxels * 4);
+			for (uint32 i = 0; Cells && i < NumVoxels; ++i)
 			{
-				SkipBytes(Ar, SizeOfChunkContents - 4);
-				SkipBytes(Ar, TotalSizeOfChildrenChunks);
-				continue;
+				const uint8 Color = Cells[i * 4 + 3];
+				Model.UsedColors[Color / 64] |= uint64(1) << (Color % 64);
 			}
+		}
+		for (int32 Word = 0; Word < 4; ++Word)
+		{
+			UsedColors[Word] |= Model.UsedColors[Word];
+		}
+	}
+}
 
-			FVoxMaterial& Material = Materials[MaterialId];
+/**
+ * Number of color indices used by any voxel, valid after CountUsedColors
+ */
+int32 FVoxDirectory::GetNumUsedColors() const
+{
+	int32 NumUsedColors = 0;
+	for (const uint64 Bits : UsedColors)
+	{
+		NumUsedColors += (int32)FMath::CountBits(Bits);
+	}
+	return NumUsedColors;
+}
 
-			TMap<FString, FString> MatDict = ReadDict(Ar);
+/**
+ * Human readable summary of directory
+ * @return FText Model count, voxel count, biggest size and used colors
+ */
+FText FVoxDirectory::GetSummary() const
+{
+	int64 NumVoxels = 0;
+	FIntVector BiggestSize = FIntVector::ZeroValue;
+	for (const FVoxModelInfo& Model : Models)
+	{
+		NumVoxels += Model.NumVoxels;
+		BiggestSize = FIntVector(FMath::Max(BiggestSize.X, Model.Size.X), FMath::Max(BiggestSize.Y, Model.Size.Y), FMath::Max(BiggestSize.Z, Model.Size.Z));
+	}
+	return FText::Format(NSLOCTEXT("VOX4U", "VoxDirectorySummary", "{0} models, {1} voxels, biggest {2} x {3} x {4}, {5} colors used{6}"),
+		FText::AsNumber(Models.Num()), FText::AsNumber(NumVoxels), FText::AsNumber(BiggestSize.X), FText::AsNumber(BiggestSize.Y), FText::AsNumber(BiggestSize.Z),
+		FText::AsNumber(GetNumUsedColors()), 0 < SceneNodes.Num() ? NSLOCTEXT("VOX4U", "VoxDirectorySceneGraph", ", scene graph") : FText::GetEmpty());
+}
 
-			bool IORChecked = false;
-			bool TransChecked = false;
+/**
+ * Probe vox file without decoding any voxel
+ * @param Buffer First byte of vox file, must outlive the directory
+ * @param BufferEnd Byte past the end of vox file
+ * @param OutDirectory Out chunk directory with used colors counted
+ * @return bool is valid or supported vox data
+ */
+bool FVox::Probe(const uint8* Buffer, const uint8* BufferEnd, FVoxDirectory& OutDirectory)
+{
+	if (!OutDirectory.Read(Buffer, BufferEnd))
+	{
+		return false;
+	}
+	OutDirectory.CountUsedColors();
+	return true;
+}
 
-			UE_LOG(LogVox, Verbose, TEXT("Material[%i]:"), MaterialId);
-			for (const auto& Pair : MatDict)
-			{
-				const FString& Key = Pair.Key;
-        		const FString& Value = Pair.Value;
+/**
+ * Import vox data from memory
+ * @param Buffer First byte of vox file
+ * @param BufferEnd Byte past the end of vox file
+ * @return bool	is valid or supported vox data
+ */
+bool FVox::Import(const uint8* Buffer, const uint8* BufferEnd, const UVoxImportOption* ImportOption)
+{
+	FVoxDirectory Directory;
+	return Directory.Read(Buffer, BufferEnd) && Import(Directory, ImportOption);
+}
 
-				if (TEXT("_type") == Key)
-				{
-					if (TEXT("_diffuse") == Value)
-					{
-						Material.Type = EVoxMaterialType::DIFFUSE;
-					}
-					else if (TEXT("_metal") == Value)
-					{
-						Material.Type = EVoxMaterialType::METAL;
-					}
-					else if (TEXT("_glass") == Value)
-					{
-						Material.Type = EVoxMaterialType::GLASS;
-					}
-					else if (TEXT("_emit") == Value)
-					{
-						Material.Type = EVoxMaterialType::EMIT;
-					}
-				}
-				else if (TEXT("_weight") == Key)
-				{
-					Material.Weight = static_cast<float>(FCString::Atof(*Value));
-				}
-				else if (TEXT("_rough") == Key)
-				{
-					Material.Roughness = static_cast<float>(FCString::Atof(*Value));
-				}
-				else if (TEXT("_metal") == Key)
-				{
-					Material.Metallic = static_cast<float>(FCString::Atof(*Value));
-				}
-				else if (TEXT("_spec") == Key || TEXT("_sp") == Key)
-				{
-					Material.Specular = static_cast<float>(FCString::Atof(*Value));
-				}
-				else if (TEXT("_ior") == Key && !IORChecked)
-				{
-					Material.IOR = static_cast<float>(FCString::Atof(*Value));
-					IORChecked = true;
-				}
-				else if (TEXT("_ri") == Key && !IORChecked)
-				{
-					Material.IOR = static_cast<float>(FCString::Atof(*Value)) - 1.0f;
-					IORChecked = true;
-				}
-				else if (TEXT("_att") == Key)
-				{
-					Material.Att = static_cast<float>(FCString::Atof(*Value));
-				}
-				else if (TEXT("_emit") == Key)
-				{
-					Material.Emissive = static_cast<float>(FCString::Atof(*Value));
-				}
-				else if (TEXT("_flux") == Key)
-				{
-					Material.EmissionPower = static_cast<float>(FCString::Atof(*Value));
-				}
-				else if (TEXT("_ldr") == Key)
-				{
-					Material.LDR = static_cast<float>(FCString::Atof(*Value));
-				}
-				else if (TEXT("_trans") == Key && !TransChecked)
-				{
-					Material.Transparency = static_cast<float>(FCString::Atof(*Value));
-					TransChecked = true;
-				}
-				else if (TEXT("_alpha") == Key && !TransChecked)
-				{
-					Material.Transparency = static_cast<float>(FCString::Atof(*Value));
-					TransChecked = true;
-				}
-				else if (TEXT("_plastic") == Key)
-				{
-					Material.Plastic = (0 != FCString::Atoi(*Value));
-				}
+/**
+ * Decode models of a chunk directory
+ * Every selected model is one task, palette and materials share one more. Unselected models keep their size
+ * but no voxel, so model ids match the file. They take used colors from a probed directory until decoded
+ * Without import option models are decoded in file axes, RemapAxes applies the option later
+ * @param Directory Chunk directory, its file buffer must still be alive
+ * @param ImportOption Import option, null keeps file axes
+ * @param SelectedModels Models to decode, all when null
+ * @param bCancel Stops decoding models once set, Import then returns false
+ * @return bool is valid or supported vox data and not canceled
+ */
+bool FVox::Import(const FVoxDirectory& Directory, const UVoxImportOption* ImportOption, const TBitArray<>* SelectedModels, const std::atomic<bool>* bCancel)
+{
+	FCStringAnsi::Strncpy(MagicNumber, "VOX ", 5);
+	VersionNumber = Directory.VersionNumber;
+	SceneNodes = Directory.SceneNodes;
+	bFileAxes = ImportOption == nullptr;
+
+	Sizes.Reset(Directory.Models.Num());
+	for (const FVoxModelInfo& Info : Directory.Models)
+	{
+		FIntVector& Size = Sizes.Add_GetRef(Info.Size);
+		if (ImportOption && ImportOption->bImportXForward)
+		{
+			Swap(Size.X, Size.Y);
+		}
+	}
+	Models.Reset();
+	Models.SetNum(Directory.Models.Num());
+
+	Materials.Init(FVoxMaterial(), 256);
+	ParallelFor(Models.Num() + 1, [&](int32 ModelId)
+	{
+		if (ModelId == Models.Num())
+		{
+			for (const FVoxReader& Contents : Directory.PaletteChunks)
+			{
+				ReadPaletteChunk(Palette, Contents);
 			}
-			SkipBytes(Ar, TotalSizeOfChildrenChunks);
+			for (const FVoxReader& Contents : Directory.MaterialChunks)
+			{
+				ReadMaterialChunk(Materials, Contents);
+			}
+			return;
 		}
-		else
+		if (SelectedModels && !(ModelId < SelectedModels->Num() && (*SelectedModels)[ModelId]))
 		{
-			FString UnknownChunk(ChunkId);
-			UE_LOG(LogVox, Warning, TEXT("Unsupported chunk [ %s ]. Skipping %d byte of chunk contents. Skipped %d byte of chunk childrens."), *UnknownChunk, SizeOfChunkContents, TotalSizeOfChildrenChunks);
-			SkipBytes(Ar, SizeOfChunkContents);
-			SkipBytes(Ar, TotalSizeOfChildrenChunks);
+			FMemory::Memcpy(Models[ModelId].UsedColors, Directory.Models[ModelId].UsedColors, sizeof(Models[ModelId].UsedColors));
+			return;
 		}
-	} while (!Ar.AtEnd());
+		if (bCancel && bCancel->load(std::memory_order_relaxed))
+		{
+			return;
+		}
+		DecodeModel(Directory, ModelId, ImportOption);
+	});
+	if (bCancel && bCancel->load())
+	{
+		UE_LOG(LogVox, Log, TEXT("Decode canceled."));
+		return false;
+	}
+
+	BiggestSize = FIntVector::ZeroValue;
+	for (const FIntVector& ModelSize : Sizes)
+	{
+		BiggestSize = FIntVector(FMath::Max(BiggestSize.X, ModelSize.X), FMath::Max(BiggestSize.Y, ModelSize.Y), FMath::Max(BiggestSize.Z, ModelSize.Z));
+	}
 
 	if (Palette.Num() == 0)
 	{
@@ -323,6 +815,75 @@ bool FVox::Import(FArchive& Ar, const UVoxImportOption* ImportOption)
 	return true;
 }
 
+/**
+ * Decode models not decoded by Import, in parallel
+ * @param Directory Chunk directory imported from, its file buffer must still be alive
+ * @param ModelIds Models to decode
+ */
+void FVox::DecodeModels(const FVoxDirectory& Directory, const TArray<uint32>& ModelIds, const UVoxImportOption* ImportOption)
+{
+	ParallelFor(ModelIds.Num(), [&](int32 Index)
+	{
+		DecodeModel(Directory, (int32)ModelIds[Index], bFileAxes ? nullptr : ImportOption);
+	});
+}
+
+/**
+ * Apply axes of import option to models decoded in file axes
+ * Models decoded later by DecodeModels are remapped while decoding
+ * @param ImportOption Import option
+ */
+void FVox::RemapAxes(const UVoxImportOption* ImportOption)
+{
+	if (!bFileAxes)
+	{
+		return;
+	}
+	const bool bXForward = ImportOption->bImportXForward;
+	ParallelFor(Models.Num(), [&](int32 ModelId)
+	{
+		Models[ModelId].Remap(bXForward);
+		if (bXForward)
+		{
+			Swap(Sizes[ModelId].X, Sizes[ModelId].Y);
+		}
+	});
+	bFileAxes = false;
+
+	BiggestSize = FIntVector::ZeroValue;
+	for (const FIntVector& ModelSize : Sizes)
+	{
+		BiggestSize = FIntVector(FMath::Max(BiggestSize.X, ModelSize.X), FMath::Max(BiggestSize.Y, ModelSize.Y), FMath::Max(BiggestSize.Z, ModelSize.Z));
+	}
+}
+
+/**
+ * Free voxels of a model, its statistics are kept
+ * @param ModelId Model index
+ */
+void FVox::ReleaseModel(const uint32 ModelId)
+{
+	Models[ModelId].Release();
+}
+
+/**
+ * Decode XYZI chunks of one model into its grid and update its statistics
+ * @param Directory Chunk directory
+ * @param ModelId Model index
+ * @param ImportOption Import option, null keeps file axes
+ */
+void FVox::DecodeModel(const FVoxDirectory& Directory, const int32 ModelId, const UVoxImportOption* ImportOption)
+{
+	FVoxModelData& Model = Models[ModelId];
+	Model.Init(Sizes[ModelId]);
+	for (const FVoxReader& Contents : Directory.Models[ModelId].VoxelChunks)
+	{
+		ReadVoxelChunk(Model, Contents, Sizes[ModelId], ImportOption);
+	}
+	Model.UpdateStatistics();
+	UE_LOG(LogVox, Verbose, TEXT("Model %d: %d voxels, bounds %s - %s"), ModelId, Model.Num(), *Model.BoundsMin.ToString(), *Model.BoundsMax.ToString());
+}
+
 /**
  * UE5
  * FVector::UpVector(0.0f, 0.0f, 1.0f);
@@ -415,16 +976,41 @@ static FVector2f TextureCoord[2][3] = {
 };
 
 /**
- * Create Optimized Raw Mesh using Monotone Mesh Generation
- * @param OutRawMesh Out raw mesh
+ * Create Optimized Mesh Description using Monotone or Greedy Mesh Generation
+ * @param OutMeshDescription Out mesh description
  * @param ImportOption Import options
  * @param ModelId Model index
  * @return bool is successful or not
  */
-bool FVox::CreateOptimizedRawMesh(FRawMesh& OutRawMesh, const UVoxImportOption* ImportOption, const uint32 ModelId) const
+bool FVox::CreateOptimizedMeshDescription(FMeshDescription& OutMeshDescription, const UVoxImportOption* ImportOption, const uint32 ModelId) const
+{
+	if (ImportOption->MeshingAlgorithm == EVoxMeshingAlgorithm::Greedy)
+	{
+		GreedyMesh Mesher(this);
+		return Mesher.CreateMeshDescription(OutMeshDescription, ImportOption, ModelId);
+	}
+	MonotoneMesh Mesher(this);
+	return Mesher.CreateMeshDescription(OutMeshDescription, ImportOption, ModelId);
+}
+
+/**
+ * Create Optimized Mesh Description of volume using Monotone or Greedy Mesh Generation
+ * @param OutMeshDescription Out mesh description
+ * @param Volume Voxel volume or chunk of it
+ * @param MaterialSlots Material slot of each color
+ * @param Offset Mesh space position of model origin
+ * @param ImportOption Import options
+ * @return bool is successful or not
+ */
+bool FVox::CreateOptimizedMeshDescription(FMeshDescription& OutMeshDescription, const FVoxVolume& Volume, const FVoxMaterialSlots& MaterialSlots, const FVector3f& Offset, const UVoxImportOption* ImportOption) const
 {
+	if (ImportOption->MeshingAlgorithm == EVoxMeshingAlgorithm::Greedy)
+	{
+		GreedyMesh Mesher(this);
+		return Mesher.CreateMeshDescription(OutMeshDescription, Volume, MaterialSlots, Offset, ImportOption->bForceSerialMeshing);
+	}
 	MonotoneMesh Mesher(this);
-	return Mesher.CreateRawMesh(OutRawMesh, ImportOption, ModelId);
+	return Mesher.CreateMeshDescription(OutMeshDescription, Volume, MaterialSlots, Offset, ImportOption->bForceSerialMeshing);
 }
 
 /**
@@ -447,76 +1033,376 @@ bool FVox::CreatePaletteTexture(UTexture2D* const& OutTexture, UVoxImportOption*
 }
 
 /**
- * Get used colors in voxels of all models
+ * Get used colors in voxels of all models, in color index order
  * @param OutPalette Out unique colors
  */
 void FVox::GetUniqueColors(TArray<uint8>& OutPalette) const 
 {
 	OutPalette.Empty();
-	for (const auto& model : Models)
+	for (int32 Color = 0; Color < 256; ++Color)
 	{
-		for (const auto& voxel : model.Voxels)
+		for (const auto& Model : Models)
 		{
-			OutPalette.AddUnique(voxel.Value);
+			if (Model.IsColorUsed((uint8)Color))
+			{
+				OutPalette.Add((uint8)Color);
+				break;
+			}
 		}
 	}
 }
 
 /**
- * Get used colors in voxels of specified model
+ * Get used colors in voxels of specified model, in color index order
  * @param OutPalette Out unique colors
  * @param ModelId Model index
  */
 void FVox::GetUniqueColors(TArray<uint8>& OutPalette, const uint32 ModelId) const
 {
 	OutPalette.Empty();
-	for (const auto& voxel : Models[ModelId].Voxels)
+	for (int32 Color = 0; Color < 256; ++Color)
+	{
+		if (Models[ModelId].IsColorUsed((uint8)Color))
+		{
+			OutPalette.Add((uint8)Color);
+		}
+	}
+}
+
+/**
+ * Sum cached histograms, no voxel is visited
+ * @param OutCounts Out occupied cells of each of the 256 color indices
+ * @param bSeparateModels Count only model of id, otherwise every model
+ * @param ModelId Model index, used only for separated models
+ */
+void FVox::GetColorCounts(TArray<int32>& OutCounts, const bool bSeparateModels, const uint32 ModelId) const
+{
+	OutCounts.Init(0, 256);
+	for (int32 Index = 0; Index < Models.Num(); ++Index)
 	{
-		OutPalette.AddUnique(voxel.Value);
+		if (bSeparateModels && Index != (int32)ModelId)
+		{
+			continue;
+		}
+		for (int32 Color = 0; Color < 256; ++Color)
+		{
+			OutCounts[Color] += Models[Index].Histogram[Color];
+		}
 	}
 }
 
 /**
- * Get biggest size
- * @param OutSize Out biggest size
+ * Get biggest size, computed once while parsing
+ * @param OutSize Out component-wise biggest model size
  */
 void FVox::GetBiggestSize(FIntVector& OutSize) const 
 {
-	OutSize = FIntVector::ZeroValue;
-	for (const auto& S : Sizes) 
+	OutSize = BiggestSize;
+}
+
+/**
+ * Create dense volume for mesh generation
+ * Merged models are written in model order, so later models win on overlapping cells
+ * @param OutVolume Out volume
+ * @param ImportOption Import options
+ * @param ModelId Model index, used only for separated models
+ */
+void FVox::CreateVolume(FVoxVolume& OutVolume, const UVoxImportOption* ImportOption, const uint32 ModelId) const
+{
+	if (ImportOption->bSeparateModels && Models[ModelId].Size == Sizes[ModelId])
 	{
-		OutSize.X = FMath::Max(OutSize.X, S.X);
-		OutSize.Y = FMath::Max(OutSize.Y, S.Y);
-		OutSize.Z = FMath::Max(OutSize.Z, S.Z);
+		// Model grid has the volume layout, copy it whole
+		const FVoxModelData& Model = Models[ModelId];
+		OutVolume.Init(Model.Size);
+		OutVolume.Voxels = Model.Colors;
+		OutVolume.NumVoxels = Model.Num();
+		OutVolume.BoundsMin = Model.BoundsMin;
+		OutVolume.BoundsMax = Model.BoundsMax;
+		OutVolume.SetSliceVoxels(Model.SliceVoxels);
 	}
+	else
+	{
+		FIntVector Size;
+		if (ImportOption->bSeparateModels)
+		{
+			Size = Sizes[ModelId];
+		}
+		else
+		{
+			GetBiggestSize(Size);
+		}
+		OutVolume.Init(Size);
+		// Occupancy is built only inside the union of model bounds
+		OutVolume.BoundsMin = Size;
+		OutVolume.BoundsMax = FIntVector::ZeroValue;
+		for (int32 Index = 0; Index < Models.Num(); ++Index)
+		{
+			const FVoxModelData& Model = Models[Index];
+			if ((ImportOption->bSeparateModels && Index != (int32)ModelId) || Model.Num() == 0)
+			{
+				continue;
+			}
+			for (FVoxModelData::FConstIterator It = Model.CreateConstIterator(); It; ++It)
+			{
+				OutVolume.Set(It.GetPosition(), It.GetColor());
+			}
+			OutVolume.BoundsMin = FIntVector(FMath::Min(OutVolume.BoundsMin.X, Model.BoundsMin.X), FMath::Min(OutVolume.BoundsMin.Y, Model.BoundsMin.Y), FMath::Min(OutVolume.BoundsMin.Z, Model.BoundsMin.Z));
+			OutVolume.BoundsMax = FIntVector(FMath::Max(OutVolume.BoundsMax.X, Model.BoundsMax.X), FMath::Max(OutVolume.BoundsMax.Y, Model.BoundsMax.Y), FMath::Max(OutVolume.BoundsMax.Z, Model.BoundsMax.Z));
+		}
+		if (OutVolume.NumVoxels == 0)
+		{
+			OutVolume.BoundsMin = OutVolume.BoundsMax = FIntVector::ZeroValue;
+		}
+	}
+	OutVolume.BuildOccupancy();
 }
 
 /**
- * Create one voxel raw mesh
- * @param OutRawMesh Out voxel raw mesh
+ * Mesh space position of model origin
+ * @param ImportOption Import options
+ * @param ModelId Model index, used only for separated models
+ * @return FVector3f Offset added to lattice positions
+ */
+FVector3f FVox::GetMeshOffset(const UVoxImportOption* ImportOption, const uint32 ModelId) const
+{
+	if (!ImportOption->bImportXYCenter)
+	{
+		return FVector3f::ZeroVector;
+	}
+	FIntVector Size;
+	if (ImportOption->bSeparateModels)
+	{
+		Size = Sizes[ModelId];
+	}
+	else
+	{
+		GetBiggestSize(Size);
+	}
+	return FVector3f(-(float)Size.X * 0.5f, -(float)Size.Y * 0.5f, 0.f);
+}
+
+/**
+ * Visit every visible shape model of the scene graph
+ * MagicaVoxel places the center cell floor(Size / 2) of a model at the translation of its transforms.
+ * Scene space uses the engine axes of the imported meshes, in voxels.
+ * @param ImportOption Import option
+ * @param Func void(uint32 ModelId, const FMatrix& ModelToScene), engine lattice of model to scene space
+ * @return bool File has a scene graph
+ */
+bool FVox::ForEachShape(const UVoxImportOption* ImportOption, TFunctionRef<void(uint32, const FMatrix&)> Func) const
+{
+	if (!SceneNodes.Contains(0))
+	{
+		return false;
+	}
+
+	// Engine axes from MagicaVoxel axes, the map is its own inverse
+	FMatrix Axes = FMatrix(FPlane(0, 0, 0, 0), FPlane(0, 0, 0, 0), FPlane(0, 0, 1, 0), FPlane(0, 0, 0, 1));
+	if (ImportOption->bImportXForward)
+	{
+		Axes.M[0][1] = -1.0, Axes.M[1][0] = -1.0;
+	}
+	else
+	{
+		Axes.M[0][0] = -1.0, Axes.M[1][1] = 1.0;
+	}
+
+	// Depth limit guards against cycles in malformed files
+	TFunction<void(int32, const FMatrix&, int32)> Visit = [&](int32 NodeId, const FMatrix& Parent, int32 Depth)
+	{
+		const FVoxSceneNode* Node = SceneNodes.Find(NodeId);
+		if (!Node || Node->bHidden || 64 < Depth)
+		{
+			return;
+		}
+
+		if (Node->Type == EVoxSceneNodeType::Transform)
+		{
+			// Row i of the packed rotation has its one non-zero entry in column Index[i]
+			const int32 Index[3] = { Node->Rotation & 3, (Node->Rotation >> 2) & 3, 3 - (Node->Rotation & 3) - ((Node->Rotation >> 2) & 3) };
+			FMatrix Local = FMatrix::Identity;
+			if (Index[0] != Index[1] && 0 <= Index[2] && Index[2] <= 2)
+			{
+				for (int32 Row = 0; Row < 3; ++Row)
+				{
+					Local.M[Row][Row] = 0.0;
+				}
+				for (int32 Row = 0; Row < 3; ++Row)
+				{
+					Local.M[Index[Row]][Row] = (Node->Rotation & (16 << Row)) ? -1.0 : 1.0;
+				}
+			}
+			Local.SetOrigin(FVector(Node->Translation));
+			for (const int32 ChildId : Node->Children)
+			{
+				Visit(ChildId, Local * Parent, Depth + 1);
+			}
+		}
+		else if (Node->Type == EVoxSceneNodeType::Group)
+		{
+			for (const int32 ChildId : Node->Children)
+			{
+				Visit(ChildId, Parent, Depth + 1);
+			}
+		}
+		else
+		{
+			for (const int32 ModelId : Node->Children)
+			{
+				if (!Sizes.IsValidIndex(ModelId))
+				{
+					continue;
+				}
+				// Model size in MagicaVoxel axes
+				FIntVector Size = Sizes[ModelId];
+				if (ImportOption->bImportXForward)
+				{
+					Swap(Size.X, Size.Y);
+				}
+				// Engine lattice is the mirrored model lattice shifted by its size
+				const FVector Lattice = ImportOption->bImportXForward ? FVector(Size.Y, Size.X, 0) : FVector(Size.X, 0, 0);
+				const FVector Pivot = FVector(Size.X / 2, Size.Y / 2, Size.Z / 2);
+				Func((uint32)ModelId, FTranslationMatrix(-Lattice) * Axes * FTranslationMatrix(-Pivot) * Parent * Axes);
+			}
+		}
+	};
+	Visit(0, FMatrix::Identity, 0);
+	return true;
+}
+
+/**
+ * Placements of visible shapes in the scene graph
+ * A model placed once at the origin gets the same transform as its mesh offset implies.
+ * @param OutInstances Out one instance per visible shape model
+ * @param ImportOption Import option, models are assumed meshed separately
+ */
+void FVox::GetShapeInstances(TArray<FVoxShapeInstance>& OutInstances, const UVoxImportOption* ImportOption) const
+{
+	OutInstances.Reset();
+	ForEachShape(ImportOption, [&](uint32 ModelId, const FMatrix& ModelToScene)
+	{
+		const FMatrix Scene = FTranslationMatrix(-FVector(GetMeshOffset(ImportOption, ModelId))) * ModelToScene;
+		FVoxShapeInstance& Instance = OutInstances.AddDefaulted_GetRef();
+		Instance.ModelId = ModelId;
+		Instance.Transform = FTransform(Scene);
+		Instance.Transform.SetTranslation(Scene.GetOrigin() * ImportOption->Scale);
+	});
+}
+
+/**
+ * Assemble visible shapes into one sparse world volume at their scene positions
+ * Files without scene graph overlay all models at the origin.
+ * Later shapes overwrite earlier ones where they overlap.
+ * @param OutWorld Out world volume
+ * @param ImportOption Import option
+ */
+void FVox::CreateWorld(FVoxWorld& OutWorld, const UVoxImportOption* ImportOption) const
+{
+	OutWorld.Init(ImportOption->ChunkSize);
+	auto AddModel = [&](uint32 ModelId, const FMatrix& ModelToScene)
+	{
+		// Rotations are signed axis permutations and cell centers land on cell centers,
+		// so doubled coordinates stay integral: 2 * Cell + 1 = A * (2 * Position + 1) + B
+		int32 A[3][3];
+		for (int32 Row = 0; Row < 3; ++Row)
+		{
+			for (int32 Column = 0; Column < 3; ++Column)
+			{
+				A[Row][Column] = FMath::RoundToInt32(ModelToScene.M[Row][Column]);
+			}
+		}
+		const FVector Origin = ModelToScene.GetOrigin();
+		const FIntVector B(FMath::RoundToInt32(Origin.X * 2.0), FMath::RoundToInt32(Origin.Y * 2.0), FMath::RoundToInt32(Origin.Z * 2.0));
+
+		for (FVoxModelData::FConstIterator It = Models[ModelId].CreateConstIterator(); It; ++It)
+		{
+			const FIntVector P = It.GetPosition() * 2 + FIntVector(1, 1, 1);
+			FIntVector Cell;
+			for (int32 Column = 0; Column < 3; ++Column)
+			{
+				Cell[Column] = (P.X * A[0][Column] + P.Y * A[1][Column] + P.Z * A[2][Column] + B[Column]) >> 1;
+			}
+			OutWorld.Set(Cell, It.GetColor());
+		}
+	};
+
+	if (!ForEachShape(ImportOption, AddModel))
+	{
+		for (int32 ModelId = 0; ModelId < Models.Num(); ++ModelId)
+		{
+			AddModel((uint32)ModelId, FMatrix::Identity);
+		}
+	}
+}
+
+/**
+ * Mesh space position of world cell zero
+ * @param World World volume
+ * @param ImportOption Import option
+ * @return FVector3f Centers the world bounds on XY when importing XY centered
+ */
+FVector3f FVox::GetWorldMeshOffset(const FVoxWorld& World, const UVoxImportOption* ImportOption) const
+{
+	if (!ImportOption->bImportXYCenter || World.NumVoxels == 0)
+	{
+		return FVector3f::ZeroVector;
+	}
+	return FVector3f(-(float)(World.Min.X + World.Max.X) * 0.5f, -(float)(World.Min.Y + World.Max.Y) * 0.5f, 0.f);
+}
+
+/**
+ * Create one voxel mesh description
+ * @param OutMeshDescription Out voxel mesh description
  * @param ImportOption Import options
  * @return bool is successful or not
  */
-bool FVox::CreateVoxelRawMesh(FRawMesh& OutRawMesh, const UVoxImportOption* ImportOption)
+bool FVox::CreateVoxelMeshDescription(FMeshDescription& OutMeshDescription, const UVoxImportOption* ImportOption)
 {
+	FStaticMeshAttributes Attributes(OutMeshDescription);
+	Attributes.Register();
+	TVertexAttributesRef<FVector3f> Positions = Attributes.GetVertexPositions();
+	TVertexInstanceAttributesRef<FVector3f> Normals = Attributes.GetVertexInstanceNormals();
+	TVertexInstanceAttributesRef<FVector3f> Tangents = Attributes.GetVertexInstanceTangents();
+	TVertexInstanceAttributesRef<float> BinormalSigns = Attributes.GetVertexInstanceBinormalSigns();
+	TVertexInstanceAttributesRef<FVector2f> UVs = Attributes.GetVertexInstanceUVs();
+
+	OutMeshDescription.ReserveNewVertices(8);
+	OutMeshDescription.ReserveNewVertexInstances(6 * 2 * 3);
+	OutMeshDescription.ReserveNewTriangles(6 * 2);
+	OutMeshDescription.ReserveNewPolygons(6 * 2);
+
+	FVertexID VertexIDs[8];
 	for (int VertexIndex = 0; VertexIndex < 8; ++VertexIndex)
 	{
-		OutRawMesh.VertexPositions.Add(Vertexes[VertexIndex] - FVector3f(0.5f, 0.5f, 0.5f));
+		VertexIDs[VertexIndex] = OutMeshDescription.CreateVertex();
+		Positions[VertexIDs[VertexIndex]] = Vertexes[VertexIndex] - FVector3f(0.5f, 0.5f, 0.5f);
 	}
-	
+
+	const FPolygonGroupID PolygonGroupID = OutMeshDescription.CreatePolygonGroup();
+	Attributes.GetPolygonGroupMaterialSlotNames()[PolygonGroupID] = FVoxMeshBuilder::GetMaterialSlotName(0);
+
 	for (int FaceIndex = 0; FaceIndex < 6; ++FaceIndex)
 	{
 		for (int PolygonIndex = 0; PolygonIndex < 2; ++PolygonIndex)
 		{
-			OutRawMesh.WedgeIndices.Add(Faces[FaceIndex][Polygons[PolygonIndex][0]]);
-			OutRawMesh.WedgeIndices.Add(Faces[FaceIndex][Polygons[PolygonIndex][1]]);
-			OutRawMesh.WedgeIndices.Add(Faces[FaceIndex][Polygons[PolygonIndex][2]]);
-			OutRawMesh.WedgeTexCoords[0].Add(TextureCoord[PolygonIndex][0]);
-			OutRawMesh.WedgeTexCoords[0].Add(TextureCoord[PolygonIndex][1]);
-			OutRawMesh.WedgeTexCoords[0].Add(TextureCoord[PolygonIndex][2]);
-			OutRawMesh.FaceMaterialIndices.Add(0);
-			OutRawMesh.FaceSmoothingMasks.Add(0);
+			FVector3f Normal, Tangent;
+			FVoxMeshBuilder::GetTriangleBasis(
+				Vertexes[Faces[FaceIndex][Polygons[PolygonIndex][0]]],
+				Vertexes[Faces[FaceIndex][Polygons[PolygonIndex][1]]],
+				Vertexes[Faces[FaceIndex][Polygons[PolygonIndex][2]]],
+				Normal, Tangent);
+
+			FVertexInstanceID Corners[3];
+			for (int Corner = 0; Corner < 3; ++Corner)
+			{
+				Corners[Corner] = OutMeshDescription.CreateVertexInstance(VertexIDs[Faces[FaceIndex][Polygons[PolygonIndex][Corner]]]);
+				Normals[Corners[Corner]] = Normal;
+				Tangents[Corners[Corner]] = Tangent;
+				BinormalSigns[Corners[Corner]] = 1.0f;
+				UVs.Set(Corners[Corner], 0, TextureCoord[PolygonIndex][Corner]);
+			}
+			OutMeshDescription.CreateTriangle(PolygonGroupID, MakeArrayView(Corners, 3));
 		}
 	}
-	return OutRawMesh.IsValidOrFixable();
+	return OutMeshDescription.Triangles().Num() == 6 * 2;
 }
\ No newline at end of file
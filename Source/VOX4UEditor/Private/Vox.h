@@ -4,19 +4,248 @@
 #pragma once
 
 #include <CoreMinimal.h>
-#include <RawMesh.h>
+#include <atomic>
+#include <MeshDescription.h>
 #include "VoxMaterial.h"
+#include "VoxMeshBuilder.h"
+#include "VoxReader.h"
 
+struct FVoxVolume;
+struct FVoxWorld;
 class UTexture2D;
 class UVoxImportOption;
 
 /**
  * @struct FVoxModelData
+ * Dense voxel grid of one model, x-fastest with an occupancy bit per cell
  */
 struct FVoxModelData 
 {
-	/** Voxels */
-	TMap<FIntVector, uint8> Voxels;
+	/** Grid size, at most 256 on each axis */
+	FIntVector Size;
+	/** Voxel color indices, x-fastest. Zero is empty */
+	TArray<uint8> Colors;
+	/** Occupied cells */
+	TBitArray<> Occupancy;
+	/** Occupied cells of each color index */
+	int32 Histogram[256];
+	/** Occupied cells of each slice along X, Y and Z */
+	TArray<int32> SliceVoxels[3];
+	/** Bit per color index used by any cell */
+	uint64 UsedColors[4];
+	/** First occupied cell, equal to BoundsMax when empty */
+	FIntVector BoundsMin;
+	/** Cell past the last occupied one */
+	FIntVector BoundsMax;
+
+public:
+
+	/**
+	 * @class FConstIterator
+	 * Visits occupied cells in grid order, skipping empty words of the occupancy
+	 */
+	class FConstIterator
+	{
+	public:
+
+		FConstIterator(const FVoxModelData& InModel)
+			: Model(InModel)
+			, It(InModel.Occupancy) {}
+
+		FORCEINLINE FConstIterator& operator++()
+		{
+			++It;
+			return *this;
+		}
+
+		FORCEINLINE explicit operator bool() const
+		{
+			return (bool)It;
+		}
+
+		/** Linear index of cell */
+		FORCEINLINE int32 GetIndex() const
+		{
+			return It.GetIndex();
+		}
+
+		/** Position of cell */
+		FORCEINLINE FIntVector GetPosition() const
+		{
+			return Model.GetPosition(It.GetIndex());
+		}
+
+		/** Color index of cell */
+		FORCEINLINE uint8 GetColor() const
+		{
+			return Model.Colors[It.GetIndex()];
+		}
+
+	private:
+
+		const FVoxModelData& Model;
+		TConstSetBitIterator<> It;
+	};
+
+	/** Create empty model */
+	FVoxModelData();
+
+	/** Allocate empty grid, clamped to the 256 cells addressable by the format */
+	void Init(const FIntVector& InSize);
+
+	/** Write voxel color, zero clears the cell. Ignores cells outside grid */
+	void Set(const FIntVector& Position, uint8 Color);
+
+	/** Compute histogram, used colors, bounds and slice counts, call after the last Set */
+	void UpdateStatistics();
+
+	/** Remap grid decoded in file axes to engine axes */
+	void Remap(const bool bXForward);
+
+	/** Free the grid, statistics are kept */
+	void Release();
+
+	/** Color index is used by any cell */
+	FORCEINLINE bool IsColorUsed(uint8 Color) const
+	{
+		return 0 != (UsedColors[Color / 64] & (uint64(1) << (Color % 64)));
+	}
+
+	/** Number of occupied cells */
+	int32 Num() const
+	{
+		return NumVoxels;
+	}
+
+	/** Iterator over occupied cells */
+	FConstIterator CreateConstIterator() const
+	{
+		return FConstIterator(*this);
+	}
+
+	/** Voxel color at position, zero when empty or out of grid */
+	FORCEINLINE uint8 Get(const FIntVector& Position) const
+	{
+		return IsInside(Position) ? Colors[GetIndex(Position)] : 0;
+	}
+
+	/** Cell at position is occupied */
+	FORCEINLINE bool Contains(const FIntVector& Position) const
+	{
+		return IsInside(Position) && Occupancy[GetIndex(Position)];
+	}
+
+	/** Position is inside grid */
+	FORCEINLINE bool IsInside(const FIntVector& Position) const
+	{
+		return 0 <= Position.X && 0 <= Position.Y && 0 <= Position.Z && Position.X < Size.X && Position.Y < Size.Y && Position.Z < Size.Z;
+	}
+
+	/** Linear index of position inside grid */
+	FORCEINLINE int32 GetIndex(const FIntVector& Position) const
+	{
+		return (Position.Z * Size.Y + Position.Y) * Size.X + Position.X;
+	}
+
+	/** Position of linear index inside grid */
+	FORCEINLINE FIntVector GetPosition(int32 Index) const
+	{
+		const int32 X = Index % Size.X;
+		Index /= Size.X;
+		return FIntVector(X, Index % Size.Y, Index / Size.Y);
+	}
+
+private:
+
+	int32 NumVoxels;
+};
+
+/** Kind of scene graph node */
+enum class EVoxSceneNodeType : uint8
+{
+	Transform,
+	Group,
+	Shape
+};
+
+/**
+ * @struct FVoxSceneNode
+ * Node of the nTRN / nGRP / nSHP scene graph, only the first animation frame is kept
+ */
+struct FVoxSceneNode
+{
+	/** Node kind */
+	EVoxSceneNodeType Type = EVoxSceneNodeType::Transform;
+	/** Transform hides its subtree */
+	bool bHidden = false;
+	/** Packed rotation of transform, identity when 4 */
+	uint8 Rotation = 4;
+	/** Translation of transform in MagicaVoxel axes */
+	FIntVector Translation = FIntVector::ZeroValue;
+	/** Child node ids of transform and group, model ids of shape */
+	TArray<int32> Children;
+};
+
+/**
+ * @struct FVoxShapeInstance
+ * Placement of one model in the scene
+ */
+struct FVoxShapeInstance
+{
+	/** Placed model */
+	uint32 ModelId;
+	/** Mesh space of model to scene space, import scale applied */
+	FTransform Transform;
+};
+
+/**
+ * @struct FVoxModelInfo
+ * Model entry of a chunk directory
+ */
+struct FVoxModelInfo
+{
+	/** Size in MagicaVoxel axes */
+	FIntVector Size = FIntVector::ZeroValue;
+	/** Voxels declared by the XYZI chunks, clamped to their contents */
+	int32 NumVoxels = 0;
+	/** Bit per color index used by the model, filled by CountUsedColors */
+	uint64 UsedColors[4] = { 0, 0, 0, 0 };
+	/** XYZI chunk contents */
+	TArray<FVoxReader, TInlineAllocator<1>> VoxelChunks;
+};
+
+/**
+ * @struct FVoxDirectory
+ * Chunk directory of a vox file, payloads are spans into the file buffer and are decoded on demand
+ */
+struct FVoxDirectory
+{
+	/** version number */
+	uint32 VersionNumber = 0;
+	/** Models in file order */
+	TArray<FVoxModelInfo> Models;
+	/** RGBA chunk contents */
+	TArray<FVoxReader, TInlineAllocator<1>> PaletteChunks;
+	/** MATL chunk contents */
+	TArray<FVoxReader> MaterialChunks;
+	/** Scene graph nodes by node id, small enough to read with the headers */
+	TMap<int32, FVoxSceneNode> SceneNodes;
+	/** Bit per color index used by any voxel, filled by CountUsedColors */
+	uint64 UsedColors[4] = { 0, 0, 0, 0 };
+
+public:
+
+	/** Walk chunk headers only */
+	bool Read(const uint8* Buffer, const uint8* BufferEnd);
+
+	/** Scan color bytes of every XYZI chunk */
+	void CountUsedColors();
+
+	/** Number of used color indices */
+	int32 GetNumUsedColors() const;
+
+	/** One line summary for dialogs and logs */
+	FText GetSummary() const;
 };
 
 /**
@@ -42,6 +271,12 @@ struct FVox
 	TArray<FColor> Palette;
 	/** Materials */
 	TArray<FVoxMaterial> Materials;
+	/** Component-wise biggest model size */
+	FIntVector BiggestSize = FIntVector::ZeroValue;
+	/** Models are in file axes until RemapAxes */
+	bool bFileAxes = false;
+	/** Scene graph nodes by node id, root is node zero */
+	TMap<int32, FVoxSceneNode> SceneNodes;
 
 public:
 
@@ -51,11 +286,35 @@ public:
 	/** Create vox data from archive */
 	FVox(const FString& Filename, FArchive& Ar, const UVoxImportOption* ImportOption);
 
+	/** Create vox data from memory */
+	FVox(const FString& Filename, const uint8* Buffer, const uint8* BufferEnd, const UVoxImportOption* ImportOption);
+
 	/** Import vox data from archive */
 	bool Import(FArchive& Ar, const UVoxImportOption* ImportOption);
 
-	/** Create FRawMesh from Voxel use Monotone mesh generation */
-	bool CreateOptimizedRawMesh(FRawMesh& OutRawMesh, const UVoxImportOption* ImportOption, const uint32 ModelId) const;
+	/** Import vox data from memory without copying it */
+	bool Import(const uint8* Buffer, const uint8* BufferEnd, const UVoxImportOption* ImportOption);
+
+	/** Import selected models of a chunk directory, all models when SelectedModels is null. Null option keeps file axes */
+	bool Import(const FVoxDirectory& Directory, const UVoxImportOption* ImportOption, const TBitArray<>* SelectedModels = nullptr, const std::atomic<bool>* bCancel = nullptr);
+
+	/** Apply axes of import option to models imported in file axes */
+	void RemapAxes(const UVoxImportOption* ImportOption);
+
+	/** Decode models of the directory this vox data was imported from */
+	void DecodeModels(const FVoxDirectory& Directory, const TArray<uint32>& ModelIds, const UVoxImportOption* ImportOption);
+
+	/** Free voxels of a model once it is meshed */
+	void ReleaseModel(const uint32 ModelId);
+
+	/** Read chunk directory and used colors without decoding voxels */
+	static bool Probe(const uint8* Buffer, const uint8* BufferEnd, FVoxDirectory& OutDirectory);
+
+	/** Create FMeshDescription from Voxel use mesh generation selected in import option */
+	bool CreateOptimizedMeshDescription(FMeshDescription& OutMeshDescription, const UVoxImportOption* ImportOption, const uint32 ModelId) const;
+
+	/** Create FMeshDescription from owned cells of volume use mesh generation selected in import option */
+	bool CreateOptimizedMeshDescription(FMeshDescription& OutMeshDescription, const FVoxVolume& Volume, const FVoxMaterialSlots& MaterialSlots, const FVector3f& Offset, const UVoxImportOption* ImportOption) const;
 
 	/** Create UTexture2D from palette */
 	bool CreatePaletteTexture(UTexture2D* const& OutTexture, UVoxImportOption* ImportOption) const;
@@ -66,9 +325,35 @@ public:
 	/** Get unique colors from model palette */
 	void GetUniqueColors(TArray<uint8>& OutPalette, const uint32 ModelId) const;
 
+	/** Occupied cells of each color index, of one model or of every model */
+	void GetColorCounts(TArray<int32>& OutCounts, const bool bSeparateModels, const uint32 ModelId) const;
+
 	/** Get biggest size */
 	void GetBiggestSize(FIntVector& OutSize) const;
 
-	/** Create one voxel raw mesh */
-	static bool CreateVoxelRawMesh(FRawMesh& OutRawMesh, const UVoxImportOption* ImportOption);
+	/** Create dense volume of one model or all models merged */
+	void CreateVolume(FVoxVolume& OutVolume, const UVoxImportOption* ImportOption, const uint32 ModelId) const;
+
+	/** Mesh space position of model origin */
+	FVector3f GetMeshOffset(const UVoxImportOption* ImportOption, const uint32 ModelId) const;
+
+	/** Placements of visible shapes in the scene graph, for models meshed separately */
+	void GetShapeInstances(TArray<FVoxShapeInstance>& OutInstances, const UVoxImportOption* ImportOption) const;
+
+	/** Sparse chunked volume of all visible shapes at their scene positions */
+	void CreateWorld(FVoxWorld& OutWorld, const UVoxImportOption* ImportOption) const;
+
+	/** Mesh space position of world cell zero */
+	FVector3f GetWorldMeshOffset(const FVoxWorld& World, const UVoxImportOption* ImportOption) const;
+
+	/** Create one voxel mesh description */
+	static bool CreateVoxelMeshDescription(FMeshDescription& OutMeshDescription, const UVoxImportOption* ImportOption);
+
+private:
+
+	/** Decode one model of directory into its grid */
+	void DecodeModel(const FVoxDirectory& Directory, const int32 ModelId, const UVoxImportOption* ImportOption);
+
+	/** Visit visible shape models with their engine lattice to scene transform, false without scene graph */
+	bool ForEachShape(const UVoxImportOption* ImportOption, TFunctionRef<void(uint32, const FMatrix&)> Func) const;
 };
\ No newline at end of file
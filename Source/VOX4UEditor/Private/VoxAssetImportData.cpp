@@ -6,7 +6,18 @@ UVoxAssetImportData::UVoxAssetImportData()
 	: VoxImportType(EVoxImportType::StaticMesh)
 	, bImportXForward(true)
 	, bImportXYCenter(true)
-	, Scale(10.f) {}
+	, Scale(10.f)
+	, MeshingAlgorithm(EVoxMeshingAlgorithm::Monotone)
+	, bChunkedMesh(false)
+	, bAssembleWorld(false)
+	, ChunkSize(32)
+	, bGenerateLODs(false)
+	, LODScreenSizes({ 0.5f, 0.25f, 0.125f })
+	, bStreamModels(false)
+	, StreamingBudgetMB(1024)
+	, bImportScene(false)
+	, bPaletteInstancing(false)
+	, ChunkGroup() {}
 
 void UVoxAssetImportData::ToVoxImportOption(UVoxImportOption& OutVoxImportOption)
 {
@@ -15,6 +26,16 @@ void UVoxAssetImportData::ToVoxImportOption(UVoxImportOption& OutVoxImportOption
 	OutVoxImportOption.bImportXYCenter = bImportXYCenter;
 	OutVoxImportOption.Scale = Scale;
 	OutVoxImportOption.BuildSettings.BuildScale3D = FVector(Scale);
+	OutVoxImportOption.MeshingAlgorithm = MeshingAlgorithm;
+	OutVoxImportOption.bChunkedMesh = bChunkedMesh;
+	OutVoxImportOption.bAssembleWorld = bAssembleWorld;
+	OutVoxImportOption.ChunkSize = ChunkSize;
+	OutVoxImportOption.bGenerateLODs = bGenerateLODs;
+	OutVoxImportOption.LODScreenSizes = LODScreenSizes;
+	OutVoxImportOption.bStreamModels = bStreamModels;
+	OutVoxImportOption.StreamingBudgetMB = StreamingBudgetMB;
+	OutVoxImportOption.bImportScene = bImportScene;
+	OutVoxImportOption.bPaletteInstancing = bPaletteInstancing;
 }
 
 void UVoxAssetImportData::FromVoxImportOption(const UVoxImportOption& VoxImportOption)
@@ -23,4 +44,14 @@ void UVoxAssetImportData::FromVoxImportOption(const UVoxImportOption& VoxImportO
 	bImportXForward = VoxImportOption.bImportXForward;
 	bImportXYCenter = VoxImportOption.bImportXYCenter;
 	Scale = VoxImportOption.Scale;
+	MeshingAlgorithm = VoxImportOption.MeshingAlgorithm;
+	bChunkedMesh = VoxImportOption.bChunkedMesh;
+	bAssembleWorld = VoxImportOption.bAssembleWorld;
+	ChunkSize = VoxImportOption.ChunkSize;
+	bGenerateLODs = VoxImportOption.bGenerateLODs;
+	LODScreenSizes = VoxImportOption.LODScreenSizes;
+	bStreamModels = VoxImportOption.bStreamModels;
+	StreamingBudgetMB = VoxImportOption.StreamingBudgetMB;
+	bImportScene = VoxImportOption.bImportScene;
+	bPaletteInstancing = VoxImportOption.bPaletteInstancing;
 }
\ No newline at end of file
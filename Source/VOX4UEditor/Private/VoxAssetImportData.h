@@ -28,6 +28,40 @@ public:
 	UPROPERTY(EditAnywhere, Category = Generic)
 	float Scale;
 
+	UPROPERTY(EditAnywhere, Category = Mesh)
+	EVoxMeshingAlgorithm MeshingAlgorithm;
+
+	UPROPERTY(EditAnywhere, Category = Mesh)
+	uint32 bChunkedMesh : 1;
+
+	UPROPERTY(EditAnywhere, Category = Mesh)
+	uint32 bAssembleWorld : 1;
+
+	UPROPERTY(EditAnywhere, Category = Mesh)
+	int32 ChunkSize;
+
+	UPROPERTY(EditAnywhere, Category = Mesh)
+	uint32 bGenerateLODs : 1;
+
+	UPROPERTY(EditAnywhere, Category = Mesh)
+	TArray<float> LODScreenSizes;
+
+	UPROPERTY(EditAnywhere, Category = Mesh)
+	uint32 bStreamModels : 1;
+
+	UPROPERTY(EditAnywhere, Category = Mesh)
+	int32 StreamingBudgetMB;
+
+	UPROPERTY(EditAnywhere, Category = Mesh)
+	uint32 bImportScene : 1;
+
+	UPROPERTY(EditAnywhere, Category = Voxel)
+	uint32 bPaletteInstancing : 1;
+
+	/** Static mesh name of the model a chunk mesh was cut from, empty for other assets */
+	UPROPERTY(VisibleAnywhere, Category = Mesh)
+	FString ChunkGroup;
+
 public:
 
 	UVoxAssetImportData();
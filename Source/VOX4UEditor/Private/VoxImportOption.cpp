@@ -18,12 +18,23 @@ UVoxImportOption::UVoxImportOption()
 	, bOneMaterial(false)
 	, ResourcesSaveLocation(EVoxResourcesSaveLocation::SubFolder)
 	, bPaletteToTexture(false)
+	, MeshingAlgorithm(EVoxMeshingAlgorithm::Monotone)
+	, bForceSerialMeshing(false)
+	, bChunkedMesh(false)
+	, bAssembleWorld(false)
+	, ChunkSize(32)
+	, bGenerateLODs(false)
+	, bStreamModels(false)
+	, StreamingBudgetMB(1024)
+	, bImportScene(false)
+	, bPaletteInstancing(false)
 	, Scale(1.f)
 {
+	LODScreenSizes = { 0.5f, 0.25f, 0.125f };
 	BuildSettings.BuildScale3D = FVector(Scale);
 }
 
-bool UVoxImportOption::GetImportOption(bool& bOutImportAll)
+bool UVoxImportOption::GetImportOption(bool& bOutImportAll, const FText& Summary)
 {
 	TSharedPtr<SWindow> ParentWindow;
 
@@ -38,7 +49,7 @@ bool UVoxImportOption::GetImportOption(bool& bOutImportAll)
 		.SizingRule(ESizingRule::Autosized);
 
 	TSharedPtr<SVoxOptionWidget> VoxOptionWidget;
-	Window->SetContent(SAssignNew(VoxOptionWidget, SVoxOptionWidget).Window(Window).ImportOption(this));
+	Window->SetContent(SAssignNew(VoxOptionWidget, SVoxOptionWidget).Window(Window).ImportOption(this).Summary(Summary));
 	FSlateApplication::Get().AddModalWindow(Window, ParentWindow, false);
 	SaveConfig();
 
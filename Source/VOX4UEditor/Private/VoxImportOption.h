@@ -32,6 +32,14 @@ enum class EVoxResourcesSaveLocation : uint8
 	SameFolder UMETA(DisplayName = "In Same Folder as Mesh")
 };
 
+/** Mesh generation algorithm */
+UENUM()
+enum class EVoxMeshingAlgorithm : uint8
+{
+	Monotone UMETA(DisplayName = "Monotone", ToolTip = "Monotone polygon decomposition, fewest triangles"),
+	Greedy UMETA(DisplayName = "Greedy", ToolTip = "Greedy rectangles, regular quad topology and fastest to generate")
+};
+
 /** Import option */
 UCLASS(config = EditorPerProjectUserSettings, HideCategories = Object)
 class UVoxImportOption : public UObject
@@ -73,11 +81,44 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Materials", Meta = (EditCondition = "bImportMaterial && !bOneMaterial", EditConditionHides))
 	uint32 bPaletteToTexture : 1;
 
+	UPROPERTY(EditAnywhere, Category = "Mesh", Meta = (EditCondition = "VoxImportType == EVoxImportType::StaticMesh", EditConditionHides))
+	EVoxMeshingAlgorithm MeshingAlgorithm;
+
+	UPROPERTY(EditAnywhere, AdvancedDisplay, Category = "Mesh", Meta = (ToolTip = "Sweep mesh planes on one thread. Output is identical to the parallel sweep"))
+	uint32 bForceSerialMeshing : 1;
+
+	UPROPERTY(EditAnywhere, Category = "Mesh", Meta = (EditCondition = "VoxImportType == EVoxImportType::StaticMesh", EditConditionHides, ToolTip = "Split large models into chunk meshes assembled by a generated Blueprint"))
+	uint32 bChunkedMesh : 1;
+
+	UPROPERTY(EditAnywhere, Category = "Mesh", Meta = (EditCondition = "VoxImportType == EVoxImportType::StaticMesh && !bSeparateModels", EditConditionHides, ToolTip = "Place models at their scene graph positions in one world of any extent, meshed in chunks"))
+	uint32 bAssembleWorld : 1;
+
+	UPROPERTY(EditAnywhere, Category = "Mesh", Meta = (EditCondition = "VoxImportType == EVoxImportType::StaticMesh && (bChunkedMesh || bAssembleWorld)", EditConditionHides, ClampMin = "8", ClampMax = "256", ToolTip = "Chunk edge length in voxels"))
+	int32 ChunkSize;
+
+	UPROPERTY(EditAnywhere, Category = "Mesh", Meta = (EditCondition = "VoxImportType == EVoxImportType::StaticMesh", EditConditionHides, ToolTip = "Add LODs meshed from a voxel pyramid, every level halves the resolution"))
+	uint32 bGenerateLODs : 1;
+
+	UPROPERTY(EditAnywhere, Category = "Mesh", Meta = (EditCondition = "VoxImportType == EVoxImportType::StaticMesh && bGenerateLODs", EditConditionHides, ClampMin = "0.0", ClampMax = "1.0", ToolTip = "Screen size of LOD1 onwards, one LOD per entry"))
+	TArray<float> LODScreenSizes;
+
+	UPROPERTY(EditAnywhere, Category = "Mesh", Meta = (EditCondition = "VoxImportType == EVoxImportType::StaticMesh && bSeparateModels", EditConditionHides, ToolTip = "Decode, mesh and build models in batches and free their voxels before the next batch"))
+	uint32 bStreamModels : 1;
+
+	UPROPERTY(EditAnywhere, Category = "Mesh", Meta = (EditCondition = "VoxImportType == EVoxImportType::StaticMesh && bSeparateModels && bStreamModels", EditConditionHides, ClampMin = "0", Units = "Megabytes", ToolTip = "Estimated working memory of one batch of decoded models, a batch always holds at least one model"))
+	int32 StreamingBudgetMB;
+
+	UPROPERTY(EditAnywhere, Category = "Mesh", Meta = (EditCondition = "VoxImportType == EVoxImportType::StaticMesh && bSeparateModels && !bChunkedMesh", EditConditionHides, ToolTip = "Build a Blueprint placing every shape of the scene graph as an instance of its model mesh"))
+	uint32 bImportScene : 1;
+
+	UPROPERTY(EditAnywhere, Category = "Voxel", Meta = (EditCondition = "VoxImportType == EVoxImportType::Voxel", EditConditionHides, ToolTip = "Share one cube mesh and pass the palette index to the material as per-instance custom data"))
+	uint32 bPaletteInstancing : 1;
+
 public:
 
 	UVoxImportOption();
 
-	bool GetImportOption(bool& bOutImportAll);
+	bool GetImportOption(bool& bOutImportAll, const FText& Summary = FText::GetEmpty());
 
 	const FMeshBuildSettings& GetBuildSettings() const 
 	{
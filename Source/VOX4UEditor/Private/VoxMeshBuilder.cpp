@@ -0,0 +1,268 @@
+// Copyright (c) 2025 Muppetsg2
+// Licensed under the MIT License.
+
+#include "VoxMeshBuilder.h"
+#include <Async/ParallelFor.h>
+#include "Vox.h"
+#include "VoxImportOption.h"
+#include "VoxVolume.h"
+
+/**
+ * Find or add vertex in plane
+ * @param Lattice Vertex lattice coordinate
+ * @return int32 Plane local vertex index
+ */
+int32 FVoxPlaneMesh::AddVertex(const FIntVector& Lattice)
+{
+	++NumWrittenVertices;
+	if (const int32* Found = VertexIndices.Find(Lattice))
+	{
+		return *Found;
+	}
+	const int32 Index = Vertices.Add(Lattice);
+	VertexIndices.Add(Lattice, Index);
+	return Index;
+}
+
+/**
+ * Add triangle
+ * @param Index1 First plane local vertex index
+ * @param Index2 Second plane local vertex index
+ * @param Index3 Third plane local vertex index
+ * @param Color Color index of triangle
+ */
+void FVoxPlaneMesh::AddTriangle(int32 Index1, int32 Index2, int32 Index3, uint8 Color)
+{
+	Indices.Add(Index1);
+	Indices.Add(Index2);
+	Indices.Add(Index3);
+	Colors.Add(Color);
+}
+
+FVoxMeshBuilder::FVoxMeshBuilder(FMeshDescription& InMeshDescription, const FVoxMaterialSlots& InMaterialSlots)
+	: MeshDescription(InMeshDescription)
+	, Attributes(InMeshDescription)
+	, MaterialSlots(InMaterialSlots)
+	, VertexIndices()
+	, PolygonGroups()
+	, NumWrittenVertices(0)
+{
+	Attributes.Register();
+}
+
+/**
+ * Reserve mesh description for every plane then append them in order
+ * @param Planes Plane meshes in sweep order
+ */
+void FVoxMeshBuilder::Append(const TArray<FVoxPlaneMesh>& Planes)
+{
+	int32 NumVertices = 0, NumTriangles = 0;
+	for (const FVoxPlaneMesh& Plane : Planes)
+	{
+		NumVertices += Plane.Vertices.Num();
+		NumTriangles += Plane.Colors.Num();
+	}
+	MeshDescription.ReserveNewVertices(NumVertices);
+	MeshDescription.ReserveNewVertexInstances(NumTriangles * 3);
+	MeshDescription.ReserveNewTriangles(NumTriangles);
+	MeshDescription.ReserveNewPolygons(NumTriangles);
+	MeshDescription.ReserveNewEdges(NumTriangles * 3);
+	VertexIndices.Reserve(NumVertices);
+
+	for (const FVoxPlaneMesh& Plane : Planes)
+	{
+		Append(Plane);
+	}
+}
+
+/**
+ * Append plane mesh
+ * Planes appended in the same order always produce the same mesh description
+ * @param Plane Plane mesh to append
+ */
+void FVoxMeshBuilder::Append(const FVoxPlaneMesh& Plane)
+{
+	TArray<FVertexID> Remap;
+	Remap.SetNumUninitialized(Plane.Vertices.Num());
+	for (int32 i = 0; i < Plane.Vertices.Num(); ++i)
+	{
+		Remap[i] = WeldVertex(Plane.Vertices[i]);
+	}
+	NumWrittenVertices += Plane.NumWrittenVertices;
+
+	TVertexInstanceAttributesRef<FVector3f> Normals = Attributes.GetVertexInstanceNormals();
+	TVertexInstanceAttributesRef<FVector3f> Tangents = Attributes.GetVertexInstanceTangents();
+	TVertexInstanceAttributesRef<float> BinormalSigns = Attributes.GetVertexInstanceBinormalSigns();
+	TVertexInstanceAttributesRef<FVector2f> UVs = Attributes.GetVertexInstanceUVs();
+
+	for (int32 Triangle = 0; Triangle < Plane.Colors.Num(); ++Triangle)
+	{
+		const uint8 Color = Plane.Colors[Triangle];
+		const FVector2f TexCoord(((double)Color + 0.5) / 256.0, 0.5);
+
+		FVector3f Positions[3];
+		for (int32 Corner = 0; Corner < 3; ++Corner)
+		{
+			const FIntVector& Lattice = Plane.Vertices[Plane.Indices[Triangle * 3 + Corner]];
+			Positions[Corner] = FVector3f(Lattice.X, Lattice.Y, Lattice.Z);
+		}
+		FVector3f Normal, Tangent;
+		GetTriangleBasis(Positions[0], Positions[1], Positions[2], Normal, Tangent);
+
+		FVertexInstanceID Corners[3];
+		for (int32 Corner = 0; Corner < 3; ++Corner)
+		{
+			Corners[Corner] = MeshDescription.CreateVertexInstance(Remap[Plane.Indices[Triangle * 3 + Corner]]);
+			Normals[Corners[Corner]] = Normal;
+			Tangents[Corners[Corner]] = Tangent;
+			BinormalSigns[Corners[Corner]] = 1.0f;
+			UVs.Set(Corners[Corner], 0, TexCoord);
+		}
+		MeshDescription.CreateTriangle(GetPolygonGroup(MaterialSlots[Color]), MakeArrayView(Corners, 3));
+	}
+}
+
+/**
+ * Finish mesh description
+ * @param Offset Mesh space position of lattice origin
+ * @param Scale Mesh space length of one lattice step
+ */
+void FVoxMeshBuilder::Finish(const FVector3f& Offset, const float Scale)
+{
+	if (!Offset.IsZero() || Scale != 1.f)
+	{
+		TVertexAttributesRef<FVector3f> Positions = Attributes.GetVertexPositions();
+		for (const FVertexID VertexID : MeshDescription.Vertices().GetElementIDs())
+		{
+			Positions[VertexID] = Positions[VertexID] * Scale + Offset;
+		}
+	}
+}
+
+/**
+ * Find or add vertex in mesh description
+ * @param Lattice Vertex lattice coordinate
+ * @return FVertexID Mesh description vertex
+ */
+FVertexID FVoxMeshBuilder::WeldVertex(const FIntVector& Lattice)
+{
+	if (const FVertexID* Found = VertexIndices.Find(Lattice))
+	{
+		return *Found;
+	}
+	const FVertexID VertexID = MeshDescription.CreateVertex();
+	Attributes.GetVertexPositions()[VertexID] = FVector3f(Lattice.X, Lattice.Y, Lattice.Z);
+	VertexIndices.Add(Lattice, VertexID);
+	return VertexID;
+}
+
+/**
+ * Find or create polygon group of material slot, named so the static mesh can resolve its material
+ * @param Slot Material slot index
+ * @return FPolygonGroupID Polygon group of slot
+ */
+FPolygonGroupID FVoxMeshBuilder::GetPolygonGroup(int32 Slot)
+{
+	if (const FPolygonGroupID* Found = PolygonGroups.Find(Slot))
+	{
+		return *Found;
+	}
+	const FPolygonGroupID PolygonGroupID = MeshDescription.CreatePolygonGroup();
+	Attributes.GetPolygonGroupMaterialSlotNames()[PolygonGroupID] = GetMaterialSlotName(Slot);
+	PolygonGroups.Add(Slot, PolygonGroupID);
+	return PolygonGroupID;
+}
+
+/**
+ * Map every palette color to its material slot once per mesh
+ * Colors missing from the model fall back to the last slot
+ * @param OutMaterialSlots Out material slot of each color
+ * @param Vox Voxel data
+ * @param ImportOption Import options
+ * @param ModelId Model index
+ */
+void FVoxMeshBuilder::CreateMaterialSlots(FVoxMaterialSlots& OutMaterialSlots, const FVox* Vox, const UVoxImportOption* ImportOption, const uint32 ModelId)
+{
+	TArray<uint8> Palette;
+	if (!ImportOption->bOneMaterial)
+	{
+		if (ImportOption->bSeparateModels)
+		{
+			Vox->GetUniqueColors(Palette, ModelId);
+		}
+		else
+		{
+			Vox->GetUniqueColors(Palette);
+		}
+	}
+
+	const int32 DefaultSlot = Palette.Num() > 0 ? Palette.Num() - 1 : 0;
+	for (int32 Color = 0; Color < OutMaterialSlots.Num(); ++Color)
+	{
+		OutMaterialSlots[Color] = DefaultSlot;
+	}
+	for (int32 Slot = 0; Slot < Palette.Num(); ++Slot)
+	{
+		OutMaterialSlots[Palette[Slot]] = Slot;
+	}
+}
+
+/**
+ * Create plane meshes of every sweep plane
+ * Planes are created in parallel and stored in sweep order, so the result does not depend on scheduling
+ * Planes between two empty slices, including every plane outside the occupied box, are left empty without a task
+ * @param OutPlanes Out plane meshes in sweep order
+ * @param Volume Volume with occupancy built
+ * @param bSerial Create planes on calling thread only
+ * @param CreatePlane Create one plane mesh from plane coordinate and axis, must only read shared data
+ */
+void FVoxMeshBuilder::SweepPlanes(TArray<FVoxPlaneMesh>& OutPlanes, const FVoxVolume& Volume, const bool bSerial, TFunctionRef<void(FVoxPlaneMesh&, const FIntVector&, const FIntVector&)> CreatePlane)
+{
+	TArray<TPair<int32, int32>> Planes;
+	for (int32 Dimension = 0; Dimension < 3; ++Dimension)
+	{
+		const int32 Depth = Volume.Size[(Dimension + 2) % 3];
+		for (int32 Z = 0; Z <= Depth; ++Z)
+		{
+			if (!Volume.IsPlaneEmpty(Dimension, Z))
+			{
+				Planes.Add(TPair<int32, int32>(Dimension, Z));
+			}
+		}
+	}
+
+	OutPlanes.Reset();
+	OutPlanes.SetNum(Planes.Num());
+	ParallelFor(Planes.Num(), [&](int32 Index)
+	{
+		const int32 Dimension = Planes[Index].Key;
+		const FIntVector Axis = FIntVector(Dimension, (Dimension + 1) % 3, (Dimension + 2) % 3);
+		FIntVector Plane = FIntVector::ZeroValue;
+		Plane[Axis.Z] = Planes[Index].Value;
+		CreatePlane(OutPlanes[Index], Plane, Axis);
+	}, bSerial ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+}
+
+/**
+ * Imported material slot name shared by the mesh polygon groups and the static mesh materials
+ * @param Slot Material slot index
+ * @return FName Slot name
+ */
+FName FVoxMeshBuilder::GetMaterialSlotName(int32 Slot)
+{
+	return FName(*FString::Printf(TEXT("VoxMaterial_%d"), Slot));
+}
+
+/**
+ * Exact basis of axis aligned triangle, normal follows the engine triangle winding
+ * @param Position0 First corner
+ * @param Position1 Second corner
+ * @param Position2 Third corner
+ * @param OutNormal Out unit normal
+ * @param OutTangent Out unit tangent perpendicular to normal
+ */
+void FVoxMeshBuilder::GetTriangleBasis(const FVector3f& Position0, const FVector3f& Position1, const FVector3f& Position2, FVector3f& OutNormal, FVector3f& OutTangent)
+{
+	OutNormal = FVector3f::CrossProduct(Position2 - Position0, Position1 - Position0).GetSafeNormal();
+	OutTangent = FVector3f(OutNormal.Z, OutNormal.X, OutNormal.Y);
+}
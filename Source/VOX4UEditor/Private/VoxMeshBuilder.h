@@ -0,0 +1,103 @@
+// Copyright (c) 2025 Muppetsg2
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <CoreMinimal.h>
+#include <Containers/StaticArray.h>
+#include <MeshDescription.h>
+#include <StaticMeshAttributes.h>
+
+struct FVox;
+struct FVoxVolume;
+class UVoxImportOption;
+
+/** Material slot of each palette color */
+typedef TStaticArray<int32, 256> FVoxMaterialSlots;
+
+/**
+ * @struct FVoxPlaneMesh
+ * Triangles of one sweep plane, indexed into plane local vertices
+ */
+struct FVoxPlaneMesh
+{
+	/** Vertices in lattice coordinates, unique in plane */
+	TArray<FIntVector> Vertices;
+	/** Triangle vertex indices, three per triangle */
+	TArray<int32> Indices;
+	/** Color index of each triangle */
+	TArray<uint8> Colors;
+	/** Vertices requested before welding */
+	int32 NumWrittenVertices = 0;
+
+public:
+
+	/** Find or add vertex at lattice coordinate */
+	int32 AddVertex(const FIntVector& Lattice);
+
+	/** Add triangle of color */
+	void AddTriangle(int32 Index1, int32 Index2, int32 Index3, uint8 Color);
+
+private:
+
+	TMap<FIntVector, int32> VertexIndices;
+};
+
+/**
+ * Merge plane meshes into mesh description in submission order
+ */
+class FVoxMeshBuilder
+{
+public:
+
+	/** Construct builder writing to mesh description */
+	FVoxMeshBuilder(FMeshDescription& InMeshDescription, const FVoxMaterialSlots& InMaterialSlots);
+
+	/** Reserve and append plane meshes in order */
+	void Append(const TArray<FVoxPlaneMesh>& Planes);
+
+	/** Append plane mesh, welding shared vertices */
+	void Append(const FVoxPlaneMesh& Plane);
+
+	/** Move vertices from lattice to mesh space once every plane is appended */
+	void Finish(const FVector3f& Offset, const float Scale = 1.f);
+
+	/** Number of vertices after welding */
+	int32 GetNumVertices() const
+	{
+		return VertexIndices.Num();
+	}
+
+	/** Number of vertices requested before welding */
+	int32 GetNumWrittenVertices() const
+	{
+		return NumWrittenVertices;
+	}
+
+	/** Map every palette color to its material slot */
+	static void CreateMaterialSlots(FVoxMaterialSlots& OutMaterialSlots, const FVox* Vox, const UVoxImportOption* ImportOption, const uint32 ModelId);
+
+	/** Imported material slot name of material slot index */
+	static FName GetMaterialSlotName(int32 Slot);
+
+	/** Create plane meshes of every sweep plane in volume of size */
+	static void SweepPlanes(TArray<FVoxPlaneMesh>& OutPlanes, const FVoxVolume& Volume, const bool bSerial, TFunctionRef<void(FVoxPlaneMesh&, const FIntVector&, const FIntVector&)> CreatePlane);
+
+	/** Exact normal and tangent of axis aligned triangle */
+	static void GetTriangleBasis(const FVector3f& Position0, const FVector3f& Position1, const FVector3f& Position2, FVector3f& OutNormal, FVector3f& OutTangent);
+
+private:
+
+	FVertexID WeldVertex(const FIntVector& Lattice);
+
+	FPolygonGroupID GetPolygonGroup(int32 Slot);
+
+private:
+
+	FMeshDescription& MeshDescription;
+	FStaticMeshAttributes Attributes;
+	const FVoxMaterialSlots& MaterialSlots;
+	TMap<FIntVector, FVertexID> VertexIndices;
+	TMap<int32, FPolygonGroupID> PolygonGroups;
+	int32 NumWrittenVertices;
+};
@@ -0,0 +1,140 @@
+// Copyright (c) 2025 Muppetsg2
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <CoreMinimal.h>
+
+/**
+ * @struct FVoxReader
+ * Bounds checked little endian reader over a byte span, never copies the span
+ * Reading past the end zero fills the output and sets the error flag
+ */
+struct FVoxReader
+{
+public:
+
+	/** Create reader over span */
+	FVoxReader(const uint8* InData, const int64 InSize)
+		: Data(InData)
+		, Size(FMath::Max<int64>(InSize, 0))
+		, Offset(0)
+		, bError(false) {}
+
+	/** Bytes left to read */
+	FORCEINLINE int64 Remaining() const
+	{
+		return Size - Offset;
+	}
+
+	/** No byte left */
+	FORCEINLINE bool AtEnd() const
+	{
+		return Size <= Offset;
+	}
+
+	/** Any read ran past the end of the span */
+	FORCEINLINE bool IsError() const
+	{
+		return bError;
+	}
+
+	/** Current read position */
+	FORCEINLINE int64 Tell() const
+	{
+		return Offset;
+	}
+
+	/** Pointer to next NumBytes bytes and advance, nullptr when span is too short */
+	FORCEINLINE const uint8* ReadSpan(const int64 NumBytes)
+	{
+		if (NumBytes < 0 || Remaining() < NumBytes)
+		{
+			bError = true;
+			Offset = Size;
+			return nullptr;
+		}
+		const uint8* Span = Data + Offset;
+		Offset += NumBytes;
+		return Span;
+	}
+
+	/** Reader over next NumBytes bytes and advance past them */
+	FORCEINLINE FVoxReader ReadReader(const int64 NumBytes)
+	{
+		const uint8* Span = ReadSpan(NumBytes);
+		return Span ? FVoxReader(Span, NumBytes) : FVoxReader(nullptr, 0);
+	}
+
+	/** Skip bytes with a single offset bump */
+	FORCEINLINE bool Skip(const int64 NumBytes)
+	{
+		return nullptr != ReadSpan(NumBytes);
+	}
+
+	/** Read bytes */
+	FORCEINLINE bool Read(void* Out, const int64 NumBytes)
+	{
+		if (const uint8* Span = ReadSpan(NumBytes))
+		{
+			FMemory::Memcpy(Out, Span, NumBytes);
+			return true;
+		}
+		FMemory::Memzero(Out, NumBytes);
+		return false;
+	}
+
+	/** Read little endian value, swapped to host order */
+	template<typename T>
+	FORCEINLINE bool Read(T& Out)
+	{
+		static_assert(TIsArithmetic<T>::Value, "Read of arithmetic types only");
+		const bool bRead = Read(&Out, sizeof(T));
+#if !PLATFORM_LITTLE_ENDIAN
+		uint8* Bytes = reinterpret_cast<uint8*>(&Out);
+		for (int32 i = 0; i < (int32)sizeof(T) / 2; ++i)
+		{
+			Swap(Bytes[i], Bytes[sizeof(T) - 1 - i]);
+		}
+#endif
+		return bRead;
+	}
+
+	/** Read length prefixed string */
+	bool ReadString(FString& Out)
+	{
+		int32 StringSize = 0;
+		Read(StringSize);
+		const ANSICHAR* String = (const ANSICHAR*)ReadSpan(FMath::Max(StringSize, 0));
+		Out.Reset();
+		if (String && 0 < StringSize)
+		{
+			const FUTF8ToTCHAR Converted(String, StringSize);
+			Out = FString(Converted.Length(), Converted.Get());
+		}
+		return nullptr != String;
+	}
+
+	/** Read dictionary of string pairs */
+	bool ReadDict(TMap<FString, FString>& Out)
+	{
+		int32 NumPairs = 0;
+		Read(NumPairs);
+		Out.Reset();
+		for (int32 i = 0; i < NumPairs && !bError; ++i)
+		{
+			FString Key, Value;
+			ReadString(Key);
+			ReadString(Value);
+			Out.Add(Key, Value);
+		}
+		return !bError;
+	}
+
+private:
+
+	const uint8* Data;
+	int64 Size;
+	int64 Offset;
+	bool bError;
+};
@@ -0,0 +1,292 @@
+// Copyright (c) 2025 Muppetsg2
+// Licensed under the MIT License.
+
+#include "VoxVolume.h"
+#include <Async/ParallelFor.h>
+
+FVoxVolume::FVoxVolume()
+	: Size(FIntVector::ZeroValue)
+	, Origin(FIntVector::ZeroValue)
+	, CellSize(1)
+	, OwnedMin(FIntVector::ZeroValue)
+	, OwnedMax(FIntVector::ZeroValue)
+	, Voxels()
+	, NumVoxels(0)
+	, BoundsMin(FIntVector::ZeroValue)
+	, BoundsMax(FIntVector::ZeroValue)
+{
+	RowWords[0] = RowWords[1] = RowWords[2] = 0;
+}
+
+/**
+ * Allocate empty volume
+ * @param InSize Volume size
+ */
+void FVoxVolume::Init(const FIntVector& InSize)
+{
+	Size = FIntVector(FMath::Max(InSize.X, 0), FMath::Max(InSize.Y, 0), FMath::Max(InSize.Z, 0));
+	OwnedMin = FIntVector::ZeroValue;
+	OwnedMax = Size;
+	Voxels.Init(0, Size.X * Size.Y * Size.Z);
+	NumVoxels = 0;
+	BoundsMin = FIntVector::ZeroValue;
+	BoundsMax = Size;
+	for (int32 Dimension = 0; Dimension < 3; ++Dimension)
+	{
+		Rows[Dimension].Empty();
+		OwnedRows[Dimension].Empty();
+		SliceVoxels[Dimension].Empty();
+		RowWords[Dimension] = 0;
+	}
+}
+
+/**
+ * Write voxel color, later writes replace earlier ones
+ * @param Position Cell position
+ * @param Color Color index, zero clears the cell
+ */
+void FVoxVolume::Set(const FIntVector& Position, uint8 Color)
+{
+	if (Position.X < 0 || Position.Y < 0 || Position.Z < 0 || Size.X <= Position.X || Size.Y <= Position.Y || Size.Z <= Position.Z)
+	{
+		return;
+	}
+	uint8& Cell = Voxels[GetIndex(Position)];
+	NumVoxels += (Cell == 0 ? 0 : -1) + (Color == 0 ? 0 : 1);
+	Cell = Color;
+}
+
+/**
+ * Slices of sweep dimension run along Axis.Z = (Dimension + 2) % 3
+ * @param AxisSliceVoxels Occupied cells of each slice along X, Y and Z, sized like the volume
+ */
+void FVoxVolume::SetSliceVoxels(const TArray<int32> (&AxisSliceVoxels)[3])
+{
+	for (int32 Dimension = 0; Dimension < 3; ++Dimension)
+	{
+		SliceVoxels[Dimension] = AxisSliceVoxels[(Dimension + 2) % 3];
+	}
+}
+
+/**
+ * Pack occupancy into 64-bit rows for every sweep dimension and count occupied cells per slice
+ * Row bits run along Axis.X, rows along Axis.Y and slices along Axis.Z of the dimension
+ * Only cells inside the bounds are scanned, rows and slices outside stay empty
+ * Slice counts already taken from the model are kept instead of being counted again
+ */
+void FVoxVolume::BuildOccupancy()
+{
+	for (int32 Dimension = 0; Dimension < 3; ++Dimension)
+	{
+		const FIntVector Axis = FIntVector(Dimension, (Dimension + 1) % 3, (Dimension + 2) % 3);
+		const int32 Width = Size[Axis.X];
+		const int32 Height = Size[Axis.Y];
+		const int32 Depth = Size[Axis.Z];
+		const int32 Words = Align((Width + 63) / 64, 2);
+		RowWords[Dimension] = Words;
+		Rows[Dimension].Init(0, Depth * Height * Words);
+		const bool bCountSlices = SliceVoxels[Dimension].Num() != Depth;
+		if (bCountSlices)
+		{
+			SliceVoxels[Dimension].Init(0, Depth);
+		}
+
+		OwnedRows[Dimension].Init(0, Words);
+		for (int32 X = FMath::Max(OwnedMin[Axis.X], 0); X < FMath::Min(OwnedMax[Axis.X], Width); ++X)
+		{
+			OwnedRows[Dimension][X / 64] |= uint64(1) << (X % 64);
+		}
+
+		const FIntVector Min(FMath::Max(BoundsMin[Axis.X], 0), FMath::Max(BoundsMin[Axis.Y], 0), FMath::Max(BoundsMin[Axis.Z], 0));
+		const FIntVector Max(FMath::Min(BoundsMax[Axis.X], Width), FMath::Min(BoundsMax[Axis.Y], Height), FMath::Min(BoundsMax[Axis.Z], Depth));
+		ParallelFor(FMath::Max(Max.Z - Min.Z, 0), [&, Dimension](int32 Slice)
+		{
+			const int32 Z = Min.Z + Slice;
+			FIntVector P = FIntVector::ZeroValue;
+			P[Axis.Z] = Z;
+			int32 NumSliceVoxels = 0;
+			for (P[Axis.Y] = Min.Y; P[Axis.Y] < Max.Y; ++P[Axis.Y])
+			{
+				uint64* Row = &Rows[Dimension][(Z * Height + P[Axis.Y]) * Words];
+				for (P[Axis.X] = Min.X; P[Axis.X] < Max.X; ++P[Axis.X])
+				{
+					if (Voxels[GetIndex(P)])
+					{
+						Row[P[Axis.X] / 64] |= uint64(1) << (P[Axis.X] % 64);
+					}
+				}
+				for (int32 Word = 0; bCountSlices && Word < Words; ++Word)
+				{
+					NumSliceVoxels += (int32)FMath::CountBits(Row[Word]);
+				}
+			}
+			if (bCountSlices)
+			{
+				SliceVoxels[Dimension][Z] = NumSliceVoxels;
+			}
+		});
+	}
+}
+
+/**
+ * Downsample volume by two on every axis
+ * A block becomes occupied when at least half of its eight cells are, and takes the most frequent color of the block
+ * Ties go to the color found first in block order, so the result is deterministic
+ * @param OutVolume Out half resolution volume, occupancy is built
+ */
+void FVoxVolume::CreateDownsampled(FVoxVolume& OutVolume) const
+{
+	OutVolume.Init(FIntVector((Size.X + 1) / 2, (Size.Y + 1) / 2, (Size.Z + 1) / 2));
+	OutVolume.Origin = FIntVector(Origin.X >> 1, Origin.Y >> 1, Origin.Z >> 1);
+	OutVolume.CellSize = CellSize * 2;
+
+	const FIntVector& OutSize = OutVolume.Size;
+	TArray<int32> SliceVoxels;
+	SliceVoxels.Init(0, OutSize.Z);
+	ParallelFor(OutSize.Z, [&](int32 Z)
+	{
+		FIntVector P(0, 0, Z);
+		for (P.Y = 0; P.Y < OutSize.Y; ++P.Y)
+		{
+			for (P.X = 0; P.X < OutSize.X; ++P.X)
+			{
+				uint8 Block[8];
+				int32 NumOccupied = 0;
+				for (int32 Corner = 0; Corner < 8; ++Corner)
+				{
+					const FIntVector Cell = P * 2 + FIntVector(Corner & 1, (Corner >> 1) & 1, (Corner >> 2) & 1);
+					Block[Corner] = Get(Cell);
+					NumOccupied += Block[Corner] ? 1 : 0;
+				}
+				if (NumOccupied * 2 < 8)
+				{
+					continue;
+				}
+
+				uint8 Color = 0;
+				int32 ColorCount = 0;
+				for (int32 Corner = 0; Corner < 8; ++Corner)
+				{
+					int32 Count = 0;
+					for (int32 Other = Corner; Other < 8; ++Other)
+					{
+						Count += Block[Other] == Block[Corner] ? 1 : 0;
+					}
+					if (Block[Corner] && ColorCount < Count)
+					{
+						Color = Block[Corner], ColorCount = Count;
+					}
+				}
+				OutVolume.Voxels[OutVolume.GetIndex(P)] = Color;
+				++SliceVoxels[Z];
+			}
+		}
+	});
+
+	for (const int32 NumSliceVoxels : SliceVoxels)
+	{
+		OutVolume.NumVoxels += NumSliceVoxels;
+	}
+	OutVolume.BuildOccupancy();
+}
+
+/**
+ * Copy chunk of volume with one cell border
+ * Border cells hide faces of chunk cells but own no faces, so every face is meshed by exactly one chunk
+ * @param OutChunk Out chunk volume
+ * @param ChunkMin First cell of chunk
+ * @param ChunkSize Chunk size, clamped to volume
+ * @return int32 Number of voxels inside chunk, border excluded
+ */
+int32 FVoxVolume::CreateChunk(FVoxVolume& OutChunk, const FIntVector& ChunkMin, const FIntVector& ChunkSize) const
+{
+	const FIntVector ChunkMax = FIntVector(
+		FMath::Min(ChunkMin.X + ChunkSize.X, Size.X),
+		FMath::Min(ChunkMin.Y + ChunkSize.Y, Size.Y),
+		FMath::Min(ChunkMin.Z + ChunkSize.Z, Size.Z));
+	const FIntVector Border = FIntVector(1, 1, 1);
+
+	OutChunk.Init(ChunkMax - ChunkMin + Border * 2);
+	OutChunk.Origin = Origin + ChunkMin - Border;
+	OutChunk.CellSize = CellSize;
+	OutChunk.OwnedMin = Border;
+	OutChunk.OwnedMax = ChunkMax - ChunkMin + Border;
+
+	int32 NumOwnedVoxels = 0;
+	FIntVector P;
+	for (P.Z = 0; P.Z < OutChunk.Size.Z; ++P.Z)
+	{
+		for (P.Y = 0; P.Y < OutChunk.Size.Y; ++P.Y)
+		{
+			for (P.X = 0; P.X < OutChunk.Size.X; ++P.X)
+			{
+				const uint8 Color = Get(ChunkMin - Border + P);
+				if (Color)
+				{
+					OutChunk.Set(P, Color);
+					const bool bOwned = OutChunk.OwnedMin.X <= P.X && P.X < OutChunk.OwnedMax.X
+						&& OutChunk.OwnedMin.Y <= P.Y && P.Y < OutChunk.OwnedMax.Y
+						&& OutChunk.OwnedMin.Z <= P.Z && P.Z < OutChunk.OwnedMax.Z;
+					NumOwnedVoxels += bOwned ? 1 : 0;
+				}
+			}
+		}
+	}
+
+	if (0 < NumOwnedVoxels)
+	{
+		OutChunk.BuildOccupancy();
+	}
+	return NumOwnedVoxels;
+}
+
+/**
+ * Faces between two slices
+ * Faces are cells where exactly one of back slice Z - 1 and front slice Z is occupied
+ * and the occupied cell is owned by this volume
+ * @param OutFaces Out face bits
+ * @param OutFrontFaces Out face bits whose front cell is occupied
+ * @param Dimension Sweep dimension
+ * @param Y Row in slice
+ * @param Z Front slice, back slice is Z - 1
+ * @return bool Row has any face
+ */
+bool FVoxVolume::GetFaceBits(FRowBits& OutFaces, FRowBits& OutFrontFaces, int32 Dimension, int32 Y, int32 Z) const
+{
+	const FIntVector Axis = FIntVector(Dimension, (Dimension + 1) % 3, (Dimension + 2) % 3);
+	const int32 Height = Size[Axis.Y];
+	const int32 Depth = Size[Axis.Z];
+	const int32 Words = RowWords[Dimension];
+	check(Words % 2 == 0);
+
+	if (Y < OwnedMin[Axis.Y] || OwnedMax[Axis.Y] <= Y)
+	{
+		return false;
+	}
+
+	static const uint64 EmptyRow[8] = { 0, };
+	check(Words <= UE_ARRAY_COUNT(EmptyRow));
+	const uint64* Back = 0 < Z && Z - 1 < Depth ? &Rows[Dimension][((Z - 1) * Height + Y) * Words] : EmptyRow;
+	const uint64* Front = Z < Depth ? &Rows[Dimension][(Z * Height + Y) * Words] : EmptyRow;
+	const uint64* OwnedBack = OwnedMin[Axis.Z] <= Z - 1 && Z - 1 < OwnedMax[Axis.Z] ? Back : EmptyRow;
+	const uint64* OwnedFront = OwnedMin[Axis.Z] <= Z && Z < OwnedMax[Axis.Z] ? Front : EmptyRow;
+	const uint64* Owned = OwnedRows[Dimension].GetData();
+
+	OutFaces.SetNumUninitialized(Words);
+	OutFrontFaces.SetNumUninitialized(Words);
+	VectorRegister4Int Any = GlobalVectorConstants::IntZero;
+	for (int32 Word = 0; Word < Words; Word += 2)
+	{
+		const VectorRegister4Int BackBits = VectorIntLoad(&Back[Word]);
+		const VectorRegister4Int FrontBits = VectorIntLoad(&Front[Word]);
+		const VectorRegister4Int OwnedBits = VectorIntAnd(VectorIntOr(VectorIntLoad(&OwnedBack[Word]), VectorIntLoad(&OwnedFront[Word])), VectorIntLoad(&Owned[Word]));
+		const VectorRegister4Int FaceBits = VectorIntAnd(VectorIntXor(BackBits, FrontBits), OwnedBits);
+		VectorIntStore(FaceBits, &OutFaces[Word]);
+		VectorIntStore(VectorIntAnd(FaceBits, FrontBits), &OutFrontFaces[Word]);
+		Any = VectorIntOr(Any, FaceBits);
+	}
+
+	alignas(16) uint64 AnyBits[2];
+	VectorIntStoreAligned(Any, AnyBits);
+	return 0 != (AnyBits[0] | AnyBits[1]);
+}
@@ -0,0 +1,145 @@
+// Copyright (c) 2025 Muppetsg2
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <CoreMinimal.h>
+
+/**
+ * @struct FVoxVolume
+ * Dense voxel color volume read by the mesh generators
+ */
+struct FVoxVolume
+{
+	/** Occupancy row words kept inline, fits rows up to 512 cells */
+	typedef TArray<uint64, TInlineAllocator<8>> FRowBits;
+
+	/** Volume size */
+	FIntVector Size;
+	/** Model position of cell zero, in cells */
+	FIntVector Origin;
+	/** Edge length of one cell in model voxels, doubles per downsampled level */
+	int32 CellSize;
+	/** First cell whose faces are meshed */
+	FIntVector OwnedMin;
+	/** Cell past the last one whose faces are meshed */
+	FIntVector OwnedMax;
+	/** Voxel color indices, x-fastest. Zero is empty */
+	TArray<uint8> Voxels;
+	/** Number of occupied cells */
+	int32 NumVoxels;
+	/** First cell that may be occupied, occupancy is built only inside the bounds */
+	FIntVector BoundsMin;
+	/** Cell past the last one that may be occupied, Init resets bounds to the whole volume */
+	FIntVector BoundsMax;
+
+public:
+
+	/** Create empty volume */
+	FVoxVolume();
+
+	/** Allocate empty volume of size */
+	void Init(const FIntVector& InSize);
+
+	/** Write voxel color, zero clears the cell */
+	void Set(const FIntVector& Position, uint8 Color);
+
+	/** Take counts of occupied cells per slice along X, Y and Z cached by the model, BuildOccupancy keeps them */
+	void SetSliceVoxels(const TArray<int32> (&AxisSliceVoxels)[3]);
+
+	/** Pack occupancy of every sweep dimension into bit rows, call after the last Set */
+	void BuildOccupancy();
+
+	/** Half resolution volume, each cell takes the majority color of a 2x2x2 block */
+	void CreateDownsampled(FVoxVolume& OutVolume) const;
+
+	/** Copy chunk with one cell border, only faces of chunk cells are meshed. Returns voxels in chunk */
+	int32 CreateChunk(FVoxVolume& OutChunk, const FIntVector& ChunkMin, const FIntVector& ChunkSize) const;
+
+	/** Slices Z - 1 and Z of sweep dimension are both empty, so the plane between them has no face */
+	FORCEINLINE bool IsPlaneEmpty(int32 Dimension, int32 Z) const
+	{
+		const TArray<int32>& Slices = SliceVoxels[Dimension];
+		return (Z < 1 || Slices.Num() < Z || Slices[Z - 1] == 0) && (Slices.Num() <= Z || Slices[Z] == 0);
+	}
+
+	/** Faces of owned cells between slices Z - 1 and Z on row Y of sweep dimension, returns false when row has no face */
+	bool GetFaceBits(FRowBits& OutFaces, FRowBits& OutFrontFaces, int32 Dimension, int32 Y, int32 Z) const;
+
+	/**
+	 * Visit runs of faces with the same signed color between slices Z - 1 and Z on row Y of sweep dimension
+	 * Positive colors face the front voxel, negative colors the back voxel
+	 * @param Func void(int32 Color, int32 Left, int32 Right)
+	 */
+	template<typename FuncType>
+	void ForEachFaceRun(int32 Dimension, int32 Y, int32 Z, FuncType&& Func) const
+	{
+		FRowBits Faces, FrontFaces;
+		if (!GetFaceBits(Faces, FrontFaces, Dimension, Y, Z))
+		{
+			return;
+		}
+
+		const FIntVector Axis = FIntVector(Dimension, (Dimension + 1) % 3, (Dimension + 2) % 3);
+		FIntVector P = FIntVector::ZeroValue;
+		P[Axis.Y] = Y;
+		P[Axis.Z] = Z;
+		FIntVector D = FIntVector::ZeroValue;
+		D[Axis.Z] = -1;
+
+		int32 RunColor = 0, RunLeft = 0, RunRight = 0;
+		for (int32 Word = 0; Word < Faces.Num(); ++Word)
+		{
+			uint64 Bits = Faces[Word];
+			while (Bits)
+			{
+				const int32 Bit = (int32)FMath::CountTrailingZeros64(Bits);
+				Bits &= Bits - 1;
+				P[Axis.X] = Word * 64 + Bit;
+				const bool bFront = 0 != (FrontFaces[Word] & (uint64(1) << Bit));
+				const int32 Color = bFront ? Voxels[GetIndex(P)] : -(int32)Voxels[GetIndex(P + D)];
+				if (Color == RunColor && P[Axis.X] == RunRight)
+				{
+					++RunRight;
+					continue;
+				}
+				if (RunColor != 0)
+				{
+					Func(RunColor, RunLeft, RunRight);
+				}
+				RunColor = Color, RunLeft = P[Axis.X], RunRight = P[Axis.X] + 1;
+			}
+		}
+		if (RunColor != 0)
+		{
+			Func(RunColor, RunLeft, RunRight);
+		}
+	}
+
+	/** Voxel color at position, zero when empty or out of volume */
+	FORCEINLINE uint8 Get(const FIntVector& Position) const
+	{
+		if (Position.X < 0 || Position.Y < 0 || Position.Z < 0 || Size.X <= Position.X || Size.Y <= Position.Y || Size.Z <= Position.Z)
+		{
+			return 0;
+		}
+		return Voxels[GetIndex(Position)];
+	}
+
+	/** Linear index of position inside volume */
+	FORCEINLINE int32 GetIndex(const FIntVector& Position) const
+	{
+		return (Position.Z * Size.Y + Position.Y) * Size.X + Position.X;
+	}
+
+private:
+
+	/** Occupancy rows of each sweep dimension, indexed by slice then row */
+	TArray<uint64> Rows[3];
+	/** Owned cells of a row of each sweep dimension */
+	TArray<uint64> OwnedRows[3];
+	/** Words per row of each sweep dimension, even for 128-bit operations */
+	int32 RowWords[3];
+	/** Occupied cells of each slice of each sweep dimension, empty slices bound the occupied box */
+	TArray<int32> SliceVoxels[3];
+};
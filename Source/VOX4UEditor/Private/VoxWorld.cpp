@@ -0,0 +1,163 @@
+// Copyright (c) 2025 Muppetsg2
+// Licensed under the MIT License.
+
+#include "VoxWorld.h"
+#include "VoxVolume.h"
+
+FVoxWorld::FVoxWorld()
+	: ChunkSize(32)
+	, Min(FIntVector::ZeroValue)
+	, Max(FIntVector::ZeroValue)
+	, Chunks()
+	, NumVoxels(0) {}
+
+/**
+ * Remove all chunks
+ * @param InChunkSize Chunk edge length in cells
+ */
+void FVoxWorld::Init(int32 InChunkSize)
+{
+	ChunkSize = FMath::Max(InChunkSize, 1);
+	Min = Max = FIntVector::ZeroValue;
+	Chunks.Empty();
+	NumVoxels = 0;
+}
+
+/**
+ * Write voxel color, later writes replace earlier ones
+ * @param Position Cell position, any integer
+ * @param Color Color index, zero clears the cell
+ */
+void FVoxWorld::Set(const FIntVector& Position, uint8 Color)
+{
+	const FIntVector ChunkCoord = GetChunkCoord(Position);
+	const FIntVector Local = Position - ChunkCoord * ChunkSize;
+	TArray<uint8>* Chunk = Chunks.Find(ChunkCoord);
+	if (!Chunk)
+	{
+		if (Color == 0)
+		{
+			return;
+		}
+		Chunk = &Chunks.Add(ChunkCoord);
+		Chunk->Init(0, ChunkSize * ChunkSize * ChunkSize);
+	}
+
+	uint8& Cell = (*Chunk)[(Local.Z * ChunkSize + Local.Y) * ChunkSize + Local.X];
+	if (Color && NumVoxels == 0)
+	{
+		Min = Position;
+		Max = Position + FIntVector(1, 1, 1);
+	}
+	else if (Color)
+	{
+		Min = FIntVector(FMath::Min(Min.X, Position.X), FMath::Min(Min.Y, Position.Y), FMath::Min(Min.Z, Position.Z));
+		Max = FIntVector(FMath::Max(Max.X, Position.X + 1), FMath::Max(Max.Y, Position.Y + 1), FMath::Max(Max.Z, Position.Z + 1));
+	}
+	NumVoxels += (Cell == 0 ? 0 : -1) + (Color == 0 ? 0 : 1);
+	Cell = Color;
+}
+
+/**
+ * Voxel color at position
+ * @param Position Cell position, any integer
+ * @return uint8 Color index, zero when empty
+ */
+uint8 FVoxWorld::Get(const FIntVector& Position) const
+{
+	const FIntVector ChunkCoord = GetChunkCoord(Position);
+	const TArray<uint8>* Chunk = Chunks.Find(ChunkCoord);
+	if (!Chunk)
+	{
+		return 0;
+	}
+	const FIntVector Local = Position - ChunkCoord * ChunkSize;
+	return (*Chunk)[(Local.Z * ChunkSize + Local.Y) * ChunkSize + Local.X];
+}
+
+/**
+ * Copy chunk with one cell border taken from the neighbouring chunks
+ * Border cells hide faces of chunk cells but own no faces, so faces between chunks and between
+ * overlapping or touching models are meshed exactly once
+ * @param OutChunk Out chunk volume, origin in world cells
+ * @param ChunkCoord Chunk coordinate
+ * @return int32 Number of voxels inside chunk, border excluded
+ */
+int32 FVoxWorld::CreateChunk(FVoxVolume& OutChunk, const FIntVector& ChunkCoord) const
+{
+	const FIntVector Border = FIntVector(1, 1, 1);
+	const int32 Extent = ChunkSize + 2;
+	OutChunk.Init(FIntVector(Extent, Extent, Extent));
+	OutChunk.Origin = ChunkCoord * ChunkSize - Border;
+	OutChunk.CellSize = 1;
+	OutChunk.OwnedMin = Border;
+	OutChunk.OwnedMax = Border + FIntVector(ChunkSize, ChunkSize, ChunkSize);
+
+	const uint8* Neighbours[27];
+	for (int32 Index = 0; Index < 27; ++Index)
+	{
+		const TArray<uint8>* Chunk = Chunks.Find(ChunkCoord + FIntVector(Index % 3 - 1, (Index / 3) % 3 - 1, Index / 9 - 1));
+		Neighbours[Index] = Chunk ? Chunk->GetData() : nullptr;
+	}
+	if (!Neighbours[13])
+	{
+		return 0;
+	}
+
+	// Row Y, Z of out chunk reads one cell of left neighbour, a full row of the middle one and one cell of right neighbour
+	auto GetSide = [this](int32 P, int32& OutLocal)
+	{
+		const int32 Side = P == 0 ? 0 : P <= ChunkSize ? 1 : 2;
+		OutLocal = Side == 0 ? ChunkSize - 1 : Side == 1 ? P - 1 : 0;
+		return Side;
+	};
+
+	int32 NumOwnedVoxels = 0;
+	for (int32 Z = 0; Z < Extent; ++Z)
+	{
+		int32 LocalZ;
+		const int32 SideZ = GetSide(Z, LocalZ);
+		for (int32 Y = 0; Y < Extent; ++Y)
+		{
+			int32 LocalY;
+			const int32 SideY = GetSide(Y, LocalY);
+			const int32 RowOffset = (LocalZ * ChunkSize + LocalY) * ChunkSize;
+			const int32 Neighbour = SideZ * 9 + SideY * 3;
+			uint8* Row = &OutChunk.Voxels[OutChunk.GetIndex(FIntVector(0, Y, Z))];
+
+			Row[0] = Neighbours[Neighbour] ? Neighbours[Neighbour][RowOffset + ChunkSize - 1] : 0;
+			if (Neighbours[Neighbour + 1])
+			{
+				FMemory::Memcpy(Row + 1, Neighbours[Neighbour + 1] + RowOffset, ChunkSize);
+			}
+			Row[Extent - 1] = Neighbours[Neighbour + 2] ? Neighbours[Neighbour + 2][RowOffset] : 0;
+
+			const bool bOwnedRow = SideY == 1 && SideZ == 1;
+			for (int32 X = 0; X < Extent; ++X)
+			{
+				const int32 bOccupied = Row[X] ? 1 : 0;
+				OutChunk.NumVoxels += bOccupied;
+				NumOwnedVoxels += bOwnedRow && 0 < X && X <= ChunkSize ? bOccupied : 0;
+			}
+		}
+	}
+
+	if (0 < NumOwnedVoxels)
+	{
+		OutChunk.BuildOccupancy();
+	}
+	return NumOwnedVoxels;
+}
+
+/**
+ * Coordinates of allocated chunks, sorted so output does not depend on hash order
+ * @param OutChunkCoords Out chunk coordinates in Z, Y, X order
+ */
+void FVoxWorld::GetChunkCoords(TArray<FIntVector>& OutChunkCoords) const
+{
+	Chunks.GenerateKeyArray(OutChunkCoords);
+	OutChunkCoords.Sort([](const FIntVector& A, const FIntVector& B)
+	{
+		return A.Z != B.Z ? A.Z < B.Z : A.Y != B.Y ? A.Y < B.Y : A.X < B.X;
+	});
+}
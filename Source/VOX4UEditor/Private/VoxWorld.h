@@ -0,0 +1,60 @@
+// Copyright (c) 2025 Muppetsg2
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <CoreMinimal.h>
+
+struct FVoxVolume;
+
+/**
+ * @struct FVoxWorld
+ * Sparse voxel color volume of unbounded extent, stored as dense cubic chunks allocated on first write
+ */
+struct FVoxWorld
+{
+	/** Edge length of one chunk in cells */
+	int32 ChunkSize;
+	/** First cell ever written with a color */
+	FIntVector Min;
+	/** Cell past the last one ever written with a color */
+	FIntVector Max;
+	/** Voxel color indices of each chunk by chunk coordinate, x-fastest. Zero is empty */
+	TMap<FIntVector, TArray<uint8>> Chunks;
+	/** Number of occupied cells */
+	int32 NumVoxels;
+
+public:
+
+	/** Create empty world */
+	FVoxWorld();
+
+	/** Remove all chunks */
+	void Init(int32 InChunkSize);
+
+	/** Write voxel color, zero clears the cell */
+	void Set(const FIntVector& Position, uint8 Color);
+
+	/** Voxel color at position, zero when empty */
+	uint8 Get(const FIntVector& Position) const;
+
+	/** Copy chunk with one cell border, only faces of chunk cells are meshed. Returns voxels in chunk */
+	int32 CreateChunk(FVoxVolume& OutChunk, const FIntVector& ChunkCoord) const;
+
+	/** Coordinates of allocated chunks in Z, Y, X order */
+	void GetChunkCoords(TArray<FIntVector>& OutChunkCoords) const;
+
+	/** Chunk holding cell */
+	FORCEINLINE FIntVector GetChunkCoord(const FIntVector& Position) const
+	{
+		return FIntVector(FloorDiv(Position.X), FloorDiv(Position.Y), FloorDiv(Position.Z));
+	}
+
+private:
+
+	/** Division rounding towards negative infinity */
+	FORCEINLINE int32 FloorDiv(int32 Value) const
+	{
+		return 0 <= Value ? Value / ChunkSize : (Value + 1) / ChunkSize - 1;
+	}
+};
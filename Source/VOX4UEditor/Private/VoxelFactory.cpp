@@ -4,23 +4,43 @@
 #include "VoxelFactory.h"
 #include <Editor.h>
 #include <AssetRegistry/AssetRegistryModule.h>
+#include <Components/InstancedStaticMeshComponent.h>
+#include <Components/StaticMeshComponent.h>
 #include <EditorFramework/AssetImportData.h>
+#include <Engine/Blueprint.h>
+#include <Engine/BlueprintGeneratedClass.h>
+#include <Engine/SCS_Node.h>
+#include <Engine/SimpleConstructionScript.h>
 #include <Engine/StaticMesh.h>
 #include <Engine/Texture2D.h>
 #include <Materials/Material.h>
 #include <Materials/MaterialExpressionTextureSample.h>
 #include <Materials/MaterialExpressionVectorParameter.h>
 #include <Materials/MaterialExpressionScalarParameter.h>
+#include <Materials/MaterialExpressionAdd.h>
+#include <Materials/MaterialExpressionComponentMask.h>
+#include <Materials/MaterialExpressionAppendVector.h>
+#include <Materials/MaterialExpressionConstant.h>
 #include <Materials/MaterialExpressionMultiply.h>
+#include <Materials/MaterialExpressionPerInstanceCustomData.h>
+#include <Materials/MaterialExpressionTextureCoordinate.h>
 #include <Materials/MaterialInstanceConstant.h>
+#include <Kismet2/KismetEditorUtilities.h>
+#include <ObjectTools.h>
 #include <MaterialEditingLibrary.h>
 #include <PhysicsEngine/BodySetup.h>
 #include <PhysicsEngine/BoxElem.h>
-#include <RawMesh.h>
+#include <MeshDescription.h>
+#include <Async/Async.h>
+#include <Misc/ScopeExit.h>
+#include <StaticMeshAttributes.h>
 #include "NameFormater.h"
 #include "VOX.h"
 #include "VoxAssetImportData.h"
 #include "VoxImportOption.h"
+#include "VoxMeshBuilder.h"
+#include "VoxVolume.h"
+#include "VoxWorld.h"
 #include "Voxel.h"
 
 DEFINE_LOG_CATEGORY_STATIC(LogVoxelFactory, Log, All)
@@ -70,12 +90,66 @@ UObject* UVoxelFactory::FactoryCreateBinary(UClass* InClass, UObject* InParent,
 
 	ImportSubsystem->OnAssetPreImport.Broadcast(this, InClass, InParent, InName, Type);
 
+	// Chunk headers only, shown in the option dialog and reused by the full parse
+	const double ProbeStartTime = FPlatformTime::Seconds();
+	FVoxDirectory Directory;
+	const bool bValid = FVox::Probe(Buffer, BufferEnd, Directory);
+	UE_LOG(LogVoxelFactory, Log, TEXT("Probed %lld bytes in %.2f ms: %s"), (int64)(BufferEnd - Buffer), (FPlatformTime::Seconds() - ProbeStartTime) * 1000.0, *Directory.GetSummary().ToString());
+
+	// Decode in file axes while the user reads the option dialog, options only remap axes afterwards.
+	// Skipped when the last import streamed models and the grids would not fit its budget
+	int64 NumGridCells = 0;
+	for (const FVoxModelInfo& Info : Directory.Models)
+	{
+		NumGridCells += (int64)Info.Size.X * Info.Size.Y * Info.Size.Z;
+	}
+	const bool bSpeculate = bValid && bShowOption
+		&& !(ImportOption->bStreamModels && (int64)ImportOption->StreamingBudgetMB * 1024 * 1024 < NumGridCells);
+	FVox SpeculativeVox;
+	std::atomic<bool> bCancelSpeculation(false);
+	TFuture<bool> Speculation;
+	if (bSpeculate)
+	{
+		Speculation = Async(EAsyncExecution::ThreadPool, [&SpeculativeVox, &Directory, &bCancelSpeculation]()
+		{
+			return SpeculativeVox.Import(Directory, nullptr, nullptr, &bCancelSpeculation);
+		});
+	}
+	// Directory spans the import buffer, speculation must finish before this call returns
+	ON_SCOPE_EXIT
+	{
+		if (Speculation.IsValid())
+		{
+			bCancelSpeculation = true;
+			Speculation.Wait();
+		}
+	};
+
 	bool bImportAll = true;
-	if (!bShowOption || ImportOption->GetImportOption(bImportAll))
+	if (bValid && (!bShowOption || ImportOption->GetImportOption(bImportAll, Directory.GetSummary())))
 	{
 		bShowOption = !bImportAll;
-		FBufferReader Reader((void*)Buffer, BufferEnd - Buffer, false);
-		FVox Vox(GetCurrentFilename(), Reader, ImportOption);
+		const double ParseStartTime = FPlatformTime::Seconds();
+		// Streaming decodes models on demand while meshing, so only palette, materials and scene are parsed here
+		const bool bStreamModels = ImportOption->bStreamModels && ImportOption->bSeparateModels && ImportOption->VoxImportType == EVoxImportType::StaticMesh;
+		if (bStreamModels && Speculation.IsValid())
+		{
+			bCancelSpeculation = true;
+		}
+		FVox Vox;
+		if (!bStreamModels && Speculation.IsValid() && Speculation.Get())
+		{
+			Vox = MoveTemp(SpeculativeVox);
+			Vox.RemapAxes(ImportOption);
+			UE_LOG(LogVoxelFactory, Log, TEXT("Reused background parse, waited %.2f ms"), (FPlatformTime::Seconds() - ParseStartTime) * 1000.0);
+		}
+		else
+		{
+			const TBitArray<> NoModels(false, Directory.Models.Num());
+			Vox.Import(Directory, ImportOption, bStreamModels ? &NoModels : nullptr);
+			UE_LOG(LogVoxelFactory, Log, TEXT("Parsed %lld bytes in %.2f ms"), (int64)(BufferEnd - Buffer), (FPlatformTime::Seconds() - ParseStartTime) * 1000.0);
+		}
+		Vox.Filename = GetCurrentFilename();
 
 		FName FinalName = InName;
 		UObject* FinalParent = InParent;
@@ -100,7 +174,7 @@ UObject* UVoxelFactory::FactoryCreateBinary(UClass* InClass, UObject* InParent,
 		switch (ImportOption->VoxImportType)
 		{
 			case EVoxImportType::StaticMesh:
-				Results.Append(CreateStaticMeshes(FinalParent, FinalName, Flags, &Vox));
+				Results.Append(CreateStaticMeshes(FinalParent, FinalName, Flags, &Vox, bStreamModels ? &Directory : nullptr));
 				break;
 			case EVoxImportType::Voxel:
 				Results.Append(CreateVoxels(FinalParent, FinalName, Flags, &Vox));
@@ -113,7 +187,19 @@ UObject* UVoxelFactory::FactoryCreateBinary(UClass* InClass, UObject* InParent,
 	else 
 	{
 		Results.Add(nullptr);
-		UE_LOG(LogVoxelFactory, Log, TEXT("Vox import canceled."));
+		if (bValid)
+		{
+			UE_LOG(LogVoxelFactory, Log, TEXT("Vox import canceled."));
+		}
+		else
+		{
+			UE_LOG(LogVoxelFactory, Log, TEXT("Vox import failed, unsupported file."));
+		}
+	}
+
+	if (Results.Num() == 0)
+	{
+		Results.Add(nullptr);
 	}
 
 	for (UObject* Result : Results)
@@ -217,7 +303,7 @@ EReimportResult::Type UVoxelFactory::Reimport(UObject* Obj)
 	return Result;
 }
 
-UStaticMesh* UVoxelFactory::CreateStaticMesh(UObject* InParent, FName InName, EObjectFlags Flags, const FVox* Vox, const uint32 ModelId) const
+UStaticMesh* UVoxelFactory::CreateStaticMesh(UObject* InParent, FName InName, EObjectFlags Flags, const FVox* Vox, const uint32 ModelId, const FString& NameSuffix) const
 {
 	FName FinalName = InName;
 	UObject* FinalParent = InParent;
@@ -230,7 +316,7 @@ UStaticMesh* UVoxelFactory::CreateStaticMesh(UObject* InParent, FName InName, EO
 		FormatArgs.ModelId = ModelId;
 	}
 
-	FString Name = NameFormater::GetFormatedName(EFormaterObjectType::StaticMesh, FormatArgs, ImportOption->AssetsNamingConvention);
+	FString Name = NameFormater::GetFormatedName(EFormaterObjectType::StaticMesh, FormatArgs, ImportOption->AssetsNamingConvention) + NameSuffix;
 	FString ParentPath = FPackageName::GetLongPackagePath(InParent->GetOutermost()->GetName());
 	FString NewPackagePath = ParentPath / Name;
 	UPackage* NewPackage = CreatePackage(*NewPackagePath);
@@ -250,9 +336,14 @@ UStaticMesh* UVoxelFactory::CreateStaticMesh(UObject* InParent, FName InName, EO
 	return StaticMesh;
 }
 
-TArray<UStaticMesh*> UVoxelFactory::CreateStaticMeshes(UObject* InParent, FName InName, EObjectFlags Flags, const FVox* Vox) const
+/**
+ * Create static meshes of merged or separate models
+ * With a directory, models are streamed: a batch of models fitting the streaming budget is decoded,
+ * every model of it is meshed and built, and its voxels are freed before the next batch is decoded
+ */
+TArray<UObject*> UVoxelFactory::CreateStaticMeshes(UObject* InParent, FName InName, EObjectFlags Flags, FVox* Vox, const FVoxDirectory* Directory) const
 {
-	TArray<UStaticMesh*> OutStaticMeshes;
+	TArray<UObject*> OutObjects;
 	TArray<uint8> Palette;
 	UMaterialInterface* Material = nullptr;
 
@@ -268,80 +359,552 @@ TArray<UStaticMesh*> UVoxelFactory::CreateStaticMeshes(UObject* InParent, FName
 		}
 	}
 
-	if (ImportOption->bSeparateModels)
+	const uint32 NumModels = ImportOption->bSeparateModels ? (uint32)Vox->Models.Num() : 1;
+	TArray<UStaticMesh*> ModelMeshes;
+	ModelMeshes.Init(nullptr, NumModels);
+
+	// Estimated working memory of a decoded model: grid, volume copy and packed rows per cell, each LOD level
+	// adding an eighth of the cells of the previous one, and per exposed face the mesh descriptions, plane
+	// builders and built render data, each LOD keeping about a quarter of the faces of the previous one.
+	// Faces are bounded by the voxels and by four times the box surface. The logged peak calibrates both terms
+	const int64 StreamingBudget = (int64)FMath::Max(ImportOption->StreamingBudgetMB, 0) << 20;
+	const int32 NumLODLevels = ImportOption->bGenerateLODs ? FMath::Min(ImportOption->LODScreenSizes.Num(), MAX_STATIC_MESH_LODS - 1) : 0;
+	const double VolumeBytesPerCell = 3.0;
+	const double MeshBytesPerFace = 768.0;
+	double VolumeScale = 0.0;
+	double MeshScale = 0.0;
+	for (int32 Level = 0; Level <= NumLODLevels; ++Level)
 	{
-		for (uint32 modelIndex = 0; modelIndex < (uint32)Vox->Models.Num(); ++modelIndex)
+		VolumeScale += 1.0 / (double)(1 << (3 * Level));
+		MeshScale += 1.0 / (double)(1 << (2 * Level));
+	}
+	auto GetModelWorkingSet = [&](uint32 ModelId)
+	{
+		const FIntVector& Size = Vox->Sizes[ModelId];
+		const int64 NumCells = (int64)Size.X * Size.Y * Size.Z;
+		const int64 NumVoxels = Directory && Directory->Models.IsValidIndex(ModelId) ? Directory->Models[ModelId].NumVoxels : NumCells;
+		const int64 BoxFaces = ((int64)Size.X * Size.Y + (int64)Size.Y * Size.Z + (int64)Size.Z * Size.X) * 4;
+		const int64 NumFaces = FMath::Min(NumVoxels * 6, BoxFaces);
+		return (int64)(NumCells * VolumeBytesPerCell * VolumeScale + NumFaces * MeshBytesPerFace * MeshScale);
+	};
+	const double StreamStartTime = FPlatformTime::Seconds();
+	const uint64 StreamStartMemory = FPlatformMemory::GetStats().UsedPhysical;
+	uint64 PeakMemory = StreamStartMemory;
+	int64 PeakBatchWorkingSet = 0;
+	uint32 BatchEnd = 0;
+	int32 NumBatches = 0;
+
+	for (uint32 ModelId = 0; ModelId < NumModels; ++ModelId)
+	{
+		if (Directory && BatchEnd <= ModelId)
+		{
+			TArray<uint32> Batch;
+			int64 BatchWorkingSet = 0;
+			for (BatchEnd = ModelId; BatchEnd < NumModels; ++BatchEnd)
+			{
+				const int64 ModelWorkingSet = GetModelWorkingSet(BatchEnd);
+				if (0 < Batch.Num() && StreamingBudget < BatchWorkingSet + ModelWorkingSet)
+				{
+					break;
+				}
+				Batch.Add(BatchEnd);
+				BatchWorkingSet += ModelWorkingSet;
+			}
+			Vox->DecodeModels(*Directory, Batch, ImportOption);
+			PeakBatchWorkingSet = FMath::Max(PeakBatchWorkingSet, BatchWorkingSet);
+			++NumBatches;
+		}
+		ON_SCOPE_EXIT
+		{
+			if (Directory)
+			{
+				// Sampled while the meshes of the model and the rest of its batch are still alive
+				PeakMemory = FMath::Max(PeakMemory, FPlatformMemory::GetStats().UsedPhysical);
+				Vox->ReleaseModel(ModelId);
+			}
+		};
+
+		if (ImportOption->bAssembleWorld && !ImportOption->bSeparateModels)
+		{
+			CreateWorldStaticMeshes(OutObjects, InParent, InName, Flags, Vox, Material, Palette);
+			continue;
+		}
+		if (ImportOption->bChunkedMesh)
 		{
-			OutStaticMeshes.Add(CreateStaticMesh(InParent, InName, Flags, Vox, modelIndex));
+			CreateChunkedStaticMeshes(OutObjects, InParent, InName, Flags, Vox, Material, Palette, ModelId);
+			continue;
 		}
+
+		UStaticMesh* StaticMesh = CreateStaticMesh(InParent, InName, Flags, Vox, ModelId);
+
+		const double MeshStartTime = FPlatformTime::Seconds();
+		TArray<FVoxVolume> Levels;
+		CreateVolumeLevels(Levels, Vox, ModelId);
+
+		FVoxMaterialSlots MaterialSlots;
+		FVoxMeshBuilder::CreateMaterialSlots(MaterialSlots, Vox, ImportOption, ModelId);
+		const FVector3f Offset = Vox->GetMeshOffset(ImportOption, ModelId);
+
+		TArray<FMeshDescription> MeshDescriptions;
+		for (const FVoxVolume& Level : Levels)
+		{
+			FMeshDescription MeshDescription;
+			if (!Vox->CreateOptimizedMeshDescription(MeshDescription, Level, MaterialSlots, Offset, ImportOption))
+			{
+				UE_LOG(LogVoxelFactory, Warning, TEXT("Failed to create optimized mesh description"));
+			}
+			if (0 < MeshDescriptions.Num() && MeshDescription.Triangles().Num() == 0)
+			{
+				break;
+			}
+			MeshDescriptions.Add(MoveTemp(MeshDescription));
+		}
+		const double MeshTime = FPlatformTime::Seconds() - MeshStartTime;
+		const int32 NumTriangles = MeshDescriptions[0].Triangles().Num();
+		const int32 NumLODs = MeshDescriptions.Num();
+
+		AddStaticMaterials(StaticMesh, InParent, InName, Vox, Material, Palette, ModelId);
+
+		const double BuildStartTime = FPlatformTime::Seconds();
+		BuildStaticMesh(StaticMesh, MeshDescriptions);
+		const double BuildTime = FPlatformTime::Seconds() - BuildStartTime;
+		UE_LOG(LogVoxelFactory, Log, TEXT("%s: %s mesh, %d triangles, %d LODs, meshed in %.2f ms, built in %.2f ms"),
+			*StaticMesh->GetName(), *UEnum::GetDisplayValueAsText(ImportOption->MeshingAlgorithm).ToString(), NumTriangles, NumLODs, MeshTime * 1000.0, BuildTime * 1000.0);
+
+		StaticMesh->GetAssetImportData()->Update(Vox->Filename);
+		OutObjects.Add(StaticMesh);
+		ModelMeshes[ModelId] = StaticMesh;
 	}
-	else 
+
+	if (Directory)
 	{
-		OutStaticMeshes.Add(CreateStaticMesh(InParent, InName, Flags, Vox, 0));
+		UE_LOG(LogVoxelFactory, Log, TEXT("Streamed %u models in %d batches of at most %d MB in %.2f s, largest batch estimated at %.1f MB, peak working set %.1f MB"),
+			NumModels, NumBatches, ImportOption->StreamingBudgetMB, FPlatformTime::Seconds() - StreamStartTime,
+			PeakBatchWorkingSet / (1024.0 * 1024.0), (PeakMemory - StreamStartMemory) / (1024.0 * 1024.0));
 	}
 
-	uint32 ModelId = 0;
-	for (UStaticMesh* StaticMesh : OutStaticMeshes)
+	if (ImportOption->bImportScene && ImportOption->bSeparateModels && !ImportOption->bChunkedMesh)
 	{
-		FRawMesh RawMesh;
-		if (!Vox->CreateOptimizedRawMesh(RawMesh, ImportOption, ModelId))
+		if (UBlueprint* Blueprint = CreateSceneBlueprint(InParent, InName, Flags, Vox, ModelMeshes))
 		{
-			UE_LOG(LogVoxelFactory, Warning, TEXT("Failed to create optimized raw mesh"));
+			OutObjects.Add(Blueprint);
 		}
+	}
 
-		if (ImportOption->bImportMaterial)
-		{
-			if (ImportOption->bOneMaterial)
-			{
-				StaticMesh->GetStaticMaterials().Add(FStaticMaterial(Material));
-			}
-			else
-			{			
-				FString BasePath = FPackageName::GetLongPackagePath(InParent->GetOutermost()->GetName());
-				FString MeshResourcesFolderPath = BasePath;
-				if (ImportOption->ResourcesSaveLocation == EVoxResourcesSaveLocation::SubFolder)
-				{
-					MeshResourcesFolderPath = BasePath / FString::Printf(TEXT("%s_Resources"), *InName.GetPlainNameString());
-				}
+	return OutObjects;
+}
 
-				TArray<uint8> ModelPalette;
-				if (ImportOption->bSeparateModels) 
-				{
-					Vox->GetUniqueColors(ModelPalette, ModelId);
-				}
-				else
-				{
-					ModelPalette.Append(Palette);
-				}
+/**
+ * Create one static mesh per non-empty chunk of model and a Blueprint placing every chunk
+ * Chunks share the model lattice, so vertices are in model space and components need no transform
+ * Faces belong to the chunk holding their voxel, seams between chunks are culled exactly like inside one mesh
+ * LODs cut every pyramid level along the same chunk grid, so chunk LODs line up with their neighbours
+ */
+void UVoxelFactory::CreateChunkedStaticMeshes(TArray<UObject*>& OutObjects, UObject* InParent, FName InName, EObjectFlags Flags, const FVox* Vox, UMaterialInterface* Material, const TArray<uint8>& Palette, const uint32 ModelId) const
+{
+	const double MeshStartTime = FPlatformTime::Seconds();
+	double BuildTime = 0.0;
+	int32 NumTriangles = 0;
+
+	TArray<FVoxVolume> Levels;
+	CreateVolumeLevels(Levels, Vox, ModelId);
+	const FVoxVolume& Volume = Levels[0];
+
+	FVoxMaterialSlots MaterialSlots;
+	FVoxMeshBuilder::CreateMaterialSlots(MaterialSlots, Vox, ImportOption, ModelId);
+	const FVector3f Offset = Vox->GetMeshOffset(ImportOption, ModelId);
 
-				NameFormatArgs FormatArgs;
-				FormatArgs.BaseName = InName.GetPlainNameString();
+	const int32 ChunkSize = FMath::Max(ImportOption->ChunkSize, 1);
+	const FIntVector ChunkExtent = FIntVector(ChunkSize, ChunkSize, ChunkSize);
 
-				for (uint8 color : ModelPalette)
+	TArray<UStaticMesh*> ChunkMeshes;
+	FVoxVolume Chunk;
+	FIntVector ChunkMin;
+	for (ChunkMin.Z = 0; ChunkMin.Z < Volume.Size.Z; ChunkMin.Z += ChunkSize)
+	{
+		for (ChunkMin.Y = 0; ChunkMin.Y < Volume.Size.Y; ChunkMin.Y += ChunkSize)
+		{
+			for (ChunkMin.X = 0; ChunkMin.X < Volume.Size.X; ChunkMin.X += ChunkSize)
+			{
+				TArray<FMeshDescription> MeshDescriptions;
+				for (int32 Level = 0; Level < Levels.Num(); ++Level)
 				{
-					FormatArgs.Color = color;
-					FString MIName = NameFormater::GetFormatedName(EFormaterObjectType::MaterialInstance, FormatArgs, ImportOption->AssetsNamingConvention);
+					const FIntVector ChunkMax = ChunkMin + ChunkExtent;
+					const FIntVector LevelMin = FIntVector(ChunkMin.X >> Level, ChunkMin.Y >> Level, ChunkMin.Z >> Level);
+					const FIntVector LevelMax = FIntVector(ChunkMax.X >> Level, ChunkMax.Y >> Level, ChunkMax.Z >> Level);
+					if (Levels[Level].CreateChunk(Chunk, LevelMin, LevelMax - LevelMin) == 0)
+					{
+						break;
+					}
 
-					FString MIPath = MeshResourcesFolderPath / FString::Printf(TEXT("%s.%s"), *MIName, *MIName);
-					UMaterialInstanceConstant* MaterialInstance = LoadObject<UMaterialInstanceConstant>(nullptr, *MIPath);
-					if (MaterialInstance)
+					FMeshDescription MeshDescription;
+					if (!Vox->CreateOptimizedMeshDescription(MeshDescription, Chunk, MaterialSlots, Offset, ImportOption))
 					{
-						StaticMesh->GetStaticMaterials().Add(FStaticMaterial(MaterialInstance));
+						UE_LOG(LogVoxelFactory, Warning, TEXT("Failed to create optimized mesh description"));
 					}
-					else
+					if (MeshDescription.Triangles().Num() == 0)
 					{
-						UE_LOG(LogVoxelFactory, Warning, TEXT("Could not find material instance at: %s"), *MIPath);
+						break;
 					}
+					MeshDescriptions.Add(MoveTemp(MeshDescription));
 				}
+				if (MeshDescriptions.Num() == 0)
+				{
+					continue;
+				}
+				NumTriangles += MeshDescriptions[0].Triangles().Num();
+
+				const FString ChunkSuffix = FString::Printf(TEXT("_Chunk_%d_%d_%d"), ChunkMin.X / ChunkSize, ChunkMin.Y / ChunkSize, ChunkMin.Z / ChunkSize);
+				UStaticMesh* StaticMesh = CreateStaticMesh(InParent, InName, Flags, Vox, ModelId, ChunkSuffix);
+				AddStaticMaterials(StaticMesh, InParent, InName, Vox, Material, Palette, ModelId);
+
+				const double BuildStartTime = FPlatformTime::Seconds();
+				BuildStaticMesh(StaticMesh, MeshDescriptions);
+				BuildTime += FPlatformTime::Seconds() - BuildStartTime;
+
+				StaticMesh->GetAssetImportData()->Update(Vox->Filename);
+				ChunkMeshes.Add(StaticMesh);
 			}
 		}
+	}
+	const double MeshTime = FPlatformTime::Seconds() - MeshStartTime - BuildTime;
+
+	UE_LOG(LogVoxelFactory, Log, TEXT("Model %u: %s mesh, %d chunks of %d, %d triangles, meshed in %.2f ms, built in %.2f ms"),
+		ModelId, *UEnum::GetDisplayValueAsText(ImportOption->MeshingAlgorithm).ToString(), ChunkMeshes.Num(), ChunkSize, NumTriangles, MeshTime * 1000.0, BuildTime * 1000.0);
+
+	OutObjects.Append(ChunkMeshes);
+	if (UBlueprint* Blueprint = CreateChunkBlueprint(InParent, InName, Flags, ModelId, ChunkMeshes))
+	{
+		OutObjects.Add(Blueprint);
+	}
+	RemoveStaleChunkMeshes(InParent, InName, ModelId, ChunkMeshes);
+}
+
+/**
+ * Create one static mesh per non-empty chunk of the assembled world and a Blueprint placing every chunk
+ * Chunk volumes carry their world origin, so vertices are in world space and components need no transform
+ * LODs are not generated, a downsampled chunk would need a wider border to line up with its neighbours
+ */
+void UVoxelFactory::CreateWorldStaticMeshes(TArray<UObject*>& OutObjects, UObject* InParent, FName InName, EObjectFlags Flags, const FVox* Vox, UMaterialInterface* Material, const TArray<uint8>& Palette) const
+{
+	const double MeshStartTime = FPlatformTime::Seconds();
+	double BuildTime = 0.0;
+	int32 NumTriangles = 0;
+
+	FVoxWorld World;
+	Vox->CreateWorld(World, ImportOption);
+	const double AssembleTime = FPlatformTime::Seconds() - MeshStartTime;
+
+	// Slots of all models merged, shared by every chunk
+	FVoxMaterialSlots MaterialSlots;
+	FVoxMeshBuilder::CreateMaterialSlots(MaterialSlots, Vox, ImportOption, 0);
+	const FVector3f Offset = Vox->GetWorldMeshOffset(World, ImportOption);
+
+	TArray<FIntVector> ChunkCoords;
+	World.GetChunkCoords(ChunkCoords);
+
+	TArray<UStaticMesh*> ChunkMeshes;
+	FVoxVolume Chunk;
+	for (const FIntVector& ChunkCoord : ChunkCoords)
+	{
+		if (World.CreateChunk(Chunk, ChunkCoord) == 0)
+		{
+			continue;
+		}
+
+		FMeshDescription MeshDescription;
+		if (!Vox->CreateOptimizedMeshDescription(MeshDescription, Chunk, MaterialSlots, Offset, ImportOption))
+		{
+			UE_LOG(LogVoxelFactory, Warning, TEXT("Failed to create optimized mesh description"));
+		}
+		if (MeshDescription.Triangles().Num() == 0)
+		{
+			continue;
+		}
+		NumTriangles += MeshDescription.Triangles().Num();
+
+		const FString ChunkSuffix = FString::Printf(TEXT("_Chunk_%d_%d_%d"), ChunkCoord.X, ChunkCoord.Y, ChunkCoord.Z);
+		UStaticMesh* StaticMesh = CreateStaticMesh(InParent, InName, Flags, Vox, 0, ChunkSuffix);
+		AddStaticMaterials(StaticMesh, InParent, InName, Vox, Material, Palette, 0);
+
+		const double BuildStartTime = FPlatformTime::Seconds();
+		BuildStaticMesh(StaticMesh, MeshDescription);
+		BuildTime += FPlatformTime::Seconds() - BuildStartTime;
 
-		BuildStaticMesh(StaticMesh, RawMesh);
 		StaticMesh->GetAssetImportData()->Update(Vox->Filename);
-		++ModelId;
+		ChunkMeshes.Add(StaticMesh);
+	}
+	const double MeshTime = FPlatformTime::Seconds() - MeshStartTime - BuildTime - AssembleTime;
+
+	const FIntVector Extent = World.Max - World.Min;
+	UE_LOG(LogVoxelFactory, Log, TEXT("World %s: %d voxels assembled in %.2f ms, %s mesh, %d chunks of %d, %d triangles, meshed in %.2f ms, built in %.2f ms"),
+		*Extent.ToString(), World.NumVoxels, AssembleTime * 1000.0, *UEnum::GetDisplayValueAsText(ImportOption->MeshingAlgorithm).ToString(),
+		ChunkMeshes.Num(), World.ChunkSize, NumTriangles, MeshTime * 1000.0, BuildTime * 1000.0);
+
+	OutObjects.Append(ChunkMeshes);
+	if (UBlueprint* Blueprint = CreateChunkBlueprint(InParent, InName, Flags, 0, ChunkMeshes))
+	{
+		OutObjects.Add(Blueprint);
+	}
+	RemoveStaleChunkMeshes(InParent, InName, 0, ChunkMeshes);
+}
+
+/**
+ * Create dense volume of model followed by its downsampled levels, one per LOD screen size
+ * Stops early once a level has no voxel left
+ */
+void UVoxelFactory::CreateVolumeLevels(TArray<FVoxVolume>& OutLevels, const FVox* Vox, const uint32 ModelId) const
+{
+	const int32 NumLODs = ImportOption->bGenerateLODs ? FMath::Min(ImportOption->LODScreenSizes.Num(), MAX_STATIC_MESH_LODS - 1) : 0;
+	OutLevels.Reset(1 + NumLODs);
+	Vox->CreateVolume(OutLevels.AddDefaulted_GetRef(), ImportOption, ModelId);
+	for (int32 LODIndex = 1; LODIndex <= NumLODs; ++LODIndex)
+	{
+		FVoxVolume Level;
+		OutLevels.Last().CreateDownsampled(Level);
+		if (Level.NumVoxels == 0)
+		{
+			break;
+		}
+		OutLevels.Add(MoveTemp(Level));
+	}
+}
+
+/**
+ * Create actor Blueprint with one static mesh component per chunk mesh
+ */
+UBlueprint* UVoxelFactory::CreateChunkBlueprint(UObject* InParent, FName InName, EObjectFlags Flags, const uint32 ModelId, const TArray<UStaticMesh*>& ChunkMeshes) const
+{
+	NameFormatArgs FormatArgs;
+	FormatArgs.BaseName = InName.GetPlainNameString();
+
+	if (ImportOption->bSeparateModels)
+	{
+		FormatArgs.ModelId = ModelId;
+	}
+
+	USCS_Node* RootNode = nullptr;
+	UBlueprint* Blueprint = CreateActorBlueprint(InParent, NameFormater::GetFormatedName(EFormaterObjectType::Blueprint, FormatArgs, ImportOption->AssetsNamingConvention), Flags, RootNode);
+	if (!Blueprint)
+	{
+		return nullptr;
+	}
+
+	USimpleConstructionScript* ConstructionScript = Blueprint->SimpleConstructionScript;
+	for (UStaticMesh* ChunkMesh : ChunkMeshes)
+	{
+		USCS_Node* Node = ConstructionScript->CreateNode(UStaticMeshComponent::StaticClass(), ChunkMesh->GetFName());
+		CastChecked<UStaticMeshComponent>(Node->ComponentTemplate)->SetStaticMesh(ChunkMesh);
+		RootNode->AddChildNode(Node);
 	}
+	FKismetEditorUtilities::CompileBlueprint(Blueprint);
 
-	return OutStaticMeshes;
+	return Blueprint;
+}
+
+/**
+ * Mark chunk meshes of model and delete chunk meshes left by an earlier import of it
+ * A different chunk size or a smaller model leaves chunks the Blueprint no longer places
+ * Chunks imported before they were marked are matched by their name
+ * @param ChunkMeshes Chunk meshes of this import, kept
+ */
+void UVoxelFactory::RemoveStaleChunkMeshes(UObject* InParent, FName InName, const uint32 ModelId, const TArray<UStaticMesh*>& ChunkMeshes) const
+{
+	NameFormatArgs FormatArgs;
+	FormatArgs.BaseName = InName.GetPlainNameString();
+
+	if (ImportOption->bSeparateModels)
+	{
+		FormatArgs.ModelId = ModelId;
+	}
+
+	const FString ChunkGroup = NameFormater::GetFormatedName(EFormaterObjectType::StaticMesh, FormatArgs, ImportOption->AssetsNamingConvention);
+	const FString ChunkPrefix = ChunkGroup + TEXT("_Chunk_");
+	for (UStaticMesh* ChunkMesh : ChunkMeshes)
+	{
+		if (UVoxAssetImportData* AssetImportData = Cast<UVoxAssetImportData>(ChunkMesh->GetAssetImportData()))
+		{
+			AssetImportData->ChunkGroup = ChunkGroup;
+		}
+	}
+
+	const FString ParentPath = FPackageName::GetLongPackagePath(InParent->GetOutermost()->GetName());
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+	TArray<FAssetData> Assets;
+	AssetRegistry.GetAssetsByPath(FName(*ParentPath), Assets, false);
+
+	TArray<UObject*> StaleMeshes;
+	for (const FAssetData& Asset : Assets)
+	{
+		if (Asset.AssetClassPath != UStaticMesh::StaticClass()->GetClassPathName() || !Asset.AssetName.ToString().StartsWith(ChunkPrefix))
+		{
+			continue;
+		}
+		UStaticMesh* StaticMesh = Cast<UStaticMesh>(Asset.GetAsset());
+		const UVoxAssetImportData* AssetImportData = StaticMesh ? Cast<UVoxAssetImportData>(StaticMesh->GetAssetImportData()) : nullptr;
+		if (AssetImportData && (AssetImportData->ChunkGroup.IsEmpty() || AssetImportData->ChunkGroup == ChunkGroup) && !ChunkMeshes.Contains(StaticMesh))
+		{
+			StaleMeshes.Add(StaticMesh);
+		}
+	}
+
+	if (0 < StaleMeshes.Num())
+	{
+		UE_LOG(LogVoxelFactory, Log, TEXT("%s: deleting %d chunk meshes of an earlier import"), *ChunkGroup, StaleMeshes.Num());
+		ObjectTools::DeleteObjectsUnchecked(StaleMeshes);
+	}
+}
+
+/**
+ * Create actor Blueprint with one instanced static mesh component per model mesh and one instance per scene shape
+ * Models placed by no visible shape get no component
+ */
+UBlueprint* UVoxelFactory::CreateSceneBlueprint(UObject* InParent, FName InName, EObjectFlags Flags, const FVox* Vox, const TArray<UStaticMesh*>& ModelMeshes) const
+{
+	TArray<FVoxShapeInstance> Instances;
+	Vox->GetShapeInstances(Instances, ImportOption);
+	if (Instances.Num() == 0)
+	{
+		UE_LOG(LogVoxelFactory, Log, TEXT("No scene graph shapes, scene blueprint skipped"));
+		return nullptr;
+	}
+
+	TArray<TArray<FTransform>> ModelTransforms;
+	ModelTransforms.SetNum(ModelMeshes.Num());
+	for (const FVoxShapeInstance& Instance : Instances)
+	{
+		if (ModelMeshes.IsValidIndex(Instance.ModelId) && ModelMeshes[Instance.ModelId])
+		{
+			ModelTransforms[Instance.ModelId].Add(Instance.Transform);
+		}
+	}
+
+	NameFormatArgs FormatArgs;
+	FormatArgs.BaseName = InName.GetPlainNameString();
+
+	USCS_Node* RootNode = nullptr;
+	UBlueprint* Blueprint = CreateActorBlueprint(InParent, NameFormater::GetFormatedName(EFormaterObjectType::Blueprint, FormatArgs, ImportOption->AssetsNamingConvention), Flags, RootNode);
+	if (!Blueprint)
+	{
+		return nullptr;
+	}
+
+	USimpleConstructionScript* ConstructionScript = Blueprint->SimpleConstructionScript;
+	int32 NumComponents = 0;
+	for (int32 ModelId = 0; ModelId < ModelMeshes.Num(); ++ModelId)
+	{
+		if (ModelTransforms[ModelId].Num() == 0)
+		{
+			continue;
+		}
+		USCS_Node* Node = ConstructionScript->CreateNode(UInstancedStaticMeshComponent::StaticClass(), ModelMeshes[ModelId]->GetFName());
+		UInstancedStaticMeshComponent* Component = CastChecked<UInstancedStaticMeshComponent>(Node->ComponentTemplate);
+		Component->SetStaticMesh(ModelMeshes[ModelId]);
+		Component->AddInstances(ModelTransforms[ModelId], false);
+		RootNode->AddChildNode(Node);
+		++NumComponents;
+	}
+	FKismetEditorUtilities::CompileBlueprint(Blueprint);
+
+	UE_LOG(LogVoxelFactory, Log, TEXT("%s: %d shapes of %d models"), *Blueprint->GetName(), Instances.Num(), NumComponents);
+	return Blueprint;
+}
+
+/**
+ * Create actor Blueprint holding only a root scene component
+ * On reimport the existing Blueprint is emptied and reused, so placed actors, child Blueprints and references keep working
+ */
+UBlueprint* UVoxelFactory::CreateActorBlueprint(UObject* InParent, const FString& Name, EObjectFlags Flags, USCS_Node*& OutRootNode) const
+{
+	FString ParentPath = FPackageName::GetLongPackagePath(InParent->GetOutermost()->GetName());
+	FString NewPackagePath = ParentPath / Name;
+	UPackage* NewPackage = CreatePackage(*NewPackagePath);
+	NewPackage->FullyLoad();
+
+	UBlueprint* Blueprint = FindObject<UBlueprint>(NewPackage, *Name);
+	if (Blueprint && Blueprint->SimpleConstructionScript)
+	{
+		Blueprint->Modify();
+		USimpleConstructionScript* ConstructionScript = Blueprint->SimpleConstructionScript;
+		ConstructionScript->Modify();
+		// Children before parents, scene roots are validated once the new root is added
+		TArray<USCS_Node*> Nodes = ConstructionScript->GetAllNodes();
+		for (int32 Index = Nodes.Num() - 1; 0 <= Index; --Index)
+		{
+			if (Nodes[Index] != ConstructionScript->GetDefaultSceneRootNode())
+			{
+				ConstructionScript->RemoveNode(Nodes[Index], false);
+			}
+		}
+	}
+	else
+	{
+		Blueprint = FKismetEditorUtilities::CreateBlueprint(AActor::StaticClass(), NewPackage, FName(*Name), BPTYPE_Normal, UBlueprint::StaticClass(), UBlueprintGeneratedClass::StaticClass());
+	}
+	if (!Blueprint || !Blueprint->SimpleConstructionScript)
+	{
+		UE_LOG(LogVoxelFactory, Warning, TEXT("Failed to create blueprint %s"), *Name);
+		return nullptr;
+	}
+	Blueprint->SetFlags(Flags | RF_Public | RF_Standalone);
+
+	USimpleConstructionScript* ConstructionScript = Blueprint->SimpleConstructionScript;
+	OutRootNode = ConstructionScript->CreateNode(USceneComponent::StaticClass(), TEXT("Root"));
+	ConstructionScript->AddNode(OutRootNode);
+	return Blueprint;
+}
+
+/**
+ * Add static materials in material slot order of model
+ */
+void UVoxelFactory::AddStaticMaterials(UStaticMesh* StaticMesh, UObject* InParent, FName InName, const FVox* Vox, UMaterialInterface* Material, const TArray<uint8>& Palette, const uint32 ModelId) const
+{
+	if (!ImportOption->bImportMaterial)
+	{
+		return;
+	}
+
+	if (ImportOption->bOneMaterial)
+	{
+		const FName SlotName = FVoxMeshBuilder::GetMaterialSlotName(0);
+		StaticMesh->GetStaticMaterials().Add(FStaticMaterial(Material, SlotName, SlotName));
+		return;
+	}
+
+	FString BasePath = FPackageName::GetLongPackagePath(InParent->GetOutermost()->GetName());
+	FString MeshResourcesFolderPath = BasePath;
+	if (ImportOption->ResourcesSaveLocation == EVoxResourcesSaveLocation::SubFolder)
+	{
+		MeshResourcesFolderPath = BasePath / FString::Printf(TEXT("%s_Resources"), *InName.GetPlainNameString());
+	}
+
+	TArray<uint8> ModelPalette;
+	if (ImportOption->bSeparateModels) 
+	{
+		Vox->GetUniqueColors(ModelPalette, ModelId);
+	}
+	else
+	{
+		ModelPalette.Append(Palette);
+	}
+
+	NameFormatArgs FormatArgs;
+	FormatArgs.BaseName = InName.GetPlainNameString();
+
+	for (int32 Slot = 0; Slot < ModelPalette.Num(); ++Slot)
+	{
+		FormatArgs.Color = ModelPalette[Slot];
+		FString MIName = NameFormater::GetFormatedName(EFormaterObjectType::MaterialInstance, FormatArgs, ImportOption->AssetsNamingConvention);
+
+		FString MIPath = MeshResourcesFolderPath / FString::Printf(TEXT("%s.%s"), *MIName, *MIName);
+		UMaterialInstanceConstant* MaterialInstance = LoadObject<UMaterialInstanceConstant>(nullptr, *MIPath);
+		if (!MaterialInstance)
+		{
+			UE_LOG(LogVoxelFactory, Warning, TEXT("Could not find material instance at: %s"), *MIPath);
+		}
+		const FName SlotName = FVoxMeshBuilder::GetMaterialSlotName(Slot);
+		StaticMesh->GetStaticMaterials().Add(FStaticMaterial(MaterialInstance, SlotName, SlotName));
+	}
 }
 
 UVoxel* UVoxelFactory::CreateUVoxel(UObject* InParent, FName InName, EObjectFlags Flags, const FVox* Vox, const uint32 ModelId) const
@@ -385,90 +948,141 @@ UVoxel* UVoxelFactory::CreateUVoxel(UObject* InParent, FName InName, EObjectFlag
 	return Voxel;
 }
 
-UVoxel* UVoxelFactory::CreateVoxel(UObject* InParent, FName InName, EObjectFlags Flags, const FVox* Vox, UMaterialInterface* Material, const FString& MeshResourcesFolderPath, const TArray<uint8>& Palette, const uint32 ModelId) const
+/**
+ * Create one voxel cube mesh
+ * @param Color Palette color of mesh, INDEX_NONE for the cube shared by every color
+ */
+UStaticMesh* UVoxelFactory::CreateVoxelMesh(FName InName, EObjectFlags Flags, UMaterialInterface* Material, const FString& MeshResourcesFolderPath, const int32 Color, const uint32 ModelId) const
 {
-	UVoxel* NewVoxel = CreateUVoxel(InParent, InName, Flags, Vox, ModelId);
-	for (const auto& color : Palette)
-	{
-		FRawMesh RawMesh;
-		FVox::CreateVoxelRawMesh(RawMesh, ImportOption);
+	FMeshDescription MeshDescription;
+	FVox::CreateVoxelMeshDescription(MeshDescription, ImportOption);
 
-		NameFormatArgs FormatArgs;
-		FormatArgs.BaseName = InName.GetPlainNameString();
-		FormatArgs.Color = color;
+	NameFormatArgs FormatArgs;
+	FormatArgs.BaseName = InName.GetPlainNameString();
+	FormatArgs.Color = Color;
 
-		if (ImportOption->bSeparateModels)
-		{
-			FormatArgs.ModelId = ModelId;
-		}
+	if (ImportOption->bSeparateModels)
+	{
+		FormatArgs.ModelId = ModelId;
+	}
 
-		FString StaticMeshName = NameFormater::GetFormatedName(EFormaterObjectType::StaticMesh, FormatArgs, ImportOption->AssetsNamingConvention);
+	FString StaticMeshName = NameFormater::GetFormatedName(EFormaterObjectType::StaticMesh, FormatArgs, ImportOption->AssetsNamingConvention);
 
-		FString StaticMeshPackagePath = MeshResourcesFolderPath / StaticMeshName;
-		UPackage* StaticMeshPackage = CreatePackage(*StaticMeshPackagePath);
-		StaticMeshPackage->FullyLoad();
+	FString StaticMeshPackagePath = MeshResourcesFolderPath / StaticMeshName;
+	UPackage* StaticMeshPackage = CreatePackage(*StaticMeshPackagePath);
+	StaticMeshPackage->FullyLoad();
 
-		UStaticMesh* StaticMesh = NewObject<UStaticMesh>(StaticMeshPackage, *StaticMeshName, Flags | RF_Public | RF_Standalone);
+	UStaticMesh* StaticMesh = NewObject<UStaticMesh>(StaticMeshPackage, *StaticMeshName, Flags | RF_Public | RF_Standalone);
 
-		if (ImportOption->bImportMaterial)
+	if (ImportOption->bImportMaterial)
+	{
+		const FName SlotName = FVoxMeshBuilder::GetMaterialSlotName(0);
+		if (ImportOption->bOneMaterial || Color == INDEX_NONE)
+		{
+			StaticMesh->GetStaticMaterials().Add(FStaticMaterial(Material, SlotName, SlotName));
+		}
+		else
 		{
-			if (ImportOption->bOneMaterial)
+			FormatArgs.ModelId = -1;
+			FString MIName = NameFormater::GetFormatedName(EFormaterObjectType::MaterialInstance, FormatArgs, ImportOption->AssetsNamingConvention);
+			FString MIPath = MeshResourcesFolderPath / FString::Printf(TEXT("%s.%s"), *MIName, *MIName);
+			UMaterialInstanceConstant* MaterialInstance = LoadObject<UMaterialInstanceConstant>(nullptr, *MIPath);
+			if (MaterialInstance)
 			{
-				StaticMesh->GetStaticMaterials().Add(FStaticMaterial(Material));
+				StaticMesh->GetStaticMaterials().Add(FStaticMaterial(MaterialInstance, SlotName, SlotName));
 			}
 			else
 			{
-				FormatArgs.ModelId = -1;
-				FString MIName = NameFormater::GetFormatedName(EFormaterObjectType::MaterialInstance, FormatArgs, ImportOption->AssetsNamingConvention);
-				FString MIPath = MeshResourcesFolderPath / FString::Printf(TEXT("%s.%s"), *MIName, *MIName);
-				UMaterialInstanceConstant* MaterialInstance = LoadObject<UMaterialInstanceConstant>(nullptr, *MIPath);
-				if (MaterialInstance)
-				{
-					StaticMesh->GetStaticMaterials().Add(FStaticMaterial(MaterialInstance));
-				}
-				else
-				{
-					UE_LOG(LogVoxelFactory, Warning, TEXT("Could not find material instance at: %s"), *MIPath);
-				}
+				UE_LOG(LogVoxelFactory, Warning, TEXT("Could not find material instance at: %s"), *MIPath);
 			}
+		}
 
-			if (ImportOption->bPaletteToTexture || ImportOption->bOneMaterial)
+		if (Color != INDEX_NONE && (ImportOption->bPaletteToTexture || ImportOption->bOneMaterial))
+		{
+			TVertexInstanceAttributesRef<FVector2f> UVs = FStaticMeshAttributes(MeshDescription).GetVertexInstanceUVs();
+			for (const FVertexInstanceID VertexInstanceID : MeshDescription.VertexInstances().GetElementIDs())
 			{
-				for (FVector2f& TexCoord : RawMesh.WedgeTexCoords[0])
-				{
-					TexCoord = FVector2f(((double)color + 0.5) / 256.0, 0.5);
-				}
+				UVs.Set(VertexInstanceID, 0, FVector2f(((double)Color + 0.5) / 256.0, 0.5));
 			}
 		}
+	}
 
-		BuildStaticMesh(StaticMesh, RawMesh);
+	BuildStaticMesh(StaticMesh, MeshDescription);
 
-		const FVector& Scale = ImportOption->GetBuildSettings().BuildScale3D;
-		FKBoxElem BoxElem(Scale.X, Scale.Y, Scale.Z);
-		StaticMesh->GetBodySetup()->AggGeom.BoxElems.Add(BoxElem);
-		StaticMeshPackage->MarkPackageDirty();
-		FAssetRegistryModule::AssetCreated(StaticMesh);
+	const FVector& Scale = ImportOption->GetBuildSettings().BuildScale3D;
+	FKBoxElem BoxElem(Scale.X, Scale.Y, Scale.Z);
+	StaticMesh->GetBodySetup()->AggGeom.BoxElems.Add(BoxElem);
+	StaticMeshPackage->MarkPackageDirty();
+	FAssetRegistryModule::AssetCreated(StaticMesh);
 
-		NewVoxel->Meshes.Add(StaticMesh);
+	return StaticMesh;
+}
+
+UVoxel* UVoxelFactory::CreateVoxel(UObject* InParent, FName InName, EObjectFlags Flags, const FVox* Vox, UMaterialInterface* Material, const FString& MeshResourcesFolderPath, const TArray<uint8>& Palette, const uint32 ModelId) const
+{
+	UVoxel* NewVoxel = CreateUVoxel(InParent, InName, Flags, Vox, ModelId);
+	NewVoxel->bPaletteInstancing = ImportOption->bPaletteInstancing;
+	if (NewVoxel->bPaletteInstancing)
+	{
+		NewVoxel->Meshes.Add(CreateVoxelMesh(InName, Flags, Material, MeshResourcesFolderPath, INDEX_NONE, ModelId));
+	}
+	else
+	{
+		for (const auto& color : Palette)
+		{
+			NewVoxel->Meshes.Add(CreateVoxelMesh(InName, Flags, Material, MeshResourcesFolderPath, color, ModelId));
+		}
+		NewVoxel->MeshColors = Palette;
 	}
+	NewVoxel->PaletteMaterial = Material;
 
+	// Mesh index of each color, palette instancing keeps raw colors
+	uint8 MeshIndices[256];
+	for (int32 Color = 0; Color < 256; ++Color)
+	{
+		MeshIndices[Color] = (uint8)Color;
+	}
+	if (!NewVoxel->bPaletteInstancing)
+	{
+		for (int32 Index = 0; Index < Palette.Num(); ++Index)
+		{
+			MeshIndices[Palette[Index]] = (uint8)Index;
+		}
+	}
+
+	auto AddCell = [&](const FIntVector& Position, uint8 Color)
+	{
+		NewVoxel->Voxels.Add(Position, MeshIndices[Color]);
+	};
+
+	// Cached histograms size the cell map and check every used color has a mesh
+	TArray<int32> ColorCounts;
+	Vox->GetColorCounts(ColorCounts, ImportOption->bSeparateModels, ModelId);
+	int32 NumCells = 0;
+	for (int32 Color = 0; Color < 256; ++Color)
+	{
+		NumCells += ColorCounts[Color];
+		if (0 < ColorCounts[Color] && !NewVoxel->bPaletteInstancing && !Palette.Contains((uint8)Color))
+		{
+			UE_LOG(LogVoxelFactory, Warning, TEXT("%s: color %d of %d voxels has no mesh"), *NewVoxel->GetName(), Color, ColorCounts[Color]);
+		}
+	}
+	NewVoxel->Voxels.Reserve(NumCells);
 
 	if (ImportOption->bSeparateModels)
 	{
-		for (const auto& Cell : Vox->Models[ModelId].Voxels)
+		for (FVoxModelData::FConstIterator It = Vox->Models[ModelId].CreateConstIterator(); It; ++It)
 		{
-			NewVoxel->Voxels.Add(Cell.Key, Palette.IndexOfByKey(Cell.Value));
-			check(INDEX_NONE != Palette.IndexOfByKey(Cell.Value));
+			AddCell(It.GetPosition(), It.GetColor());
 		}
 	}
 	else
 	{
 		for (const auto& Model : Vox->Models)
 		{
-			for (const auto& Cell : Model.Voxels)
+			for (FVoxModelData::FConstIterator It = Model.CreateConstIterator(); It; ++It)
 			{
-				NewVoxel->Voxels.Add(Cell.Key, Palette.IndexOfByKey(Cell.Value));
-				check(INDEX_NONE != Palette.IndexOfByKey(Cell.Value));
+				AddCell(It.GetPosition(), It.GetColor());
 			}
 		}
 	}
@@ -482,7 +1096,14 @@ TArray<UVoxel*> UVoxelFactory::CreateVoxels(UObject* InParent, FName InName, EOb
 	TArray<uint8> Palette;
 	UMaterialInterface* Material = nullptr;
 
-	if (ImportOption->bImportMaterial)
+	if (ImportOption->bPaletteInstancing)
+	{
+		if (ImportOption->bImportMaterial)
+		{
+			Material = CreateMaterial(InParent, InName, Flags, Vox, true);
+		}
+	}
+	else if (ImportOption->bImportMaterial)
 	{
 		if (ImportOption->bOneMaterial)
 		{
@@ -535,28 +1156,48 @@ TArray<UVoxel*> UVoxelFactory::CreateVoxels(UObject* InParent, FName InName, EOb
 	return OutVoxels;
 }
 
-UStaticMesh* UVoxelFactory::BuildStaticMesh(UStaticMesh* OutStaticMesh, FRawMesh& RawMesh) const
+UStaticMesh* UVoxelFactory::BuildStaticMesh(UStaticMesh* OutStaticMesh, FMeshDescription& MeshDescription) const
+{
+	TArray<FMeshDescription> MeshDescriptions;
+	MeshDescriptions.Add(MoveTemp(MeshDescription));
+	return BuildStaticMesh(OutStaticMesh, MeshDescriptions);
+}
+
+UStaticMesh* UVoxelFactory::BuildStaticMesh(UStaticMesh* OutStaticMesh, TArray<FMeshDescription>& MeshDescriptions) const
 {
 	check(OutStaticMesh);
 	const FVector3f& Scale = FVector3f(ImportOption->GetBuildSettings().BuildScale3D);
-	if (!Scale.Equals(FVector3f(1.0f)))
+	for (int32 LODIndex = 0; LODIndex < MeshDescriptions.Num(); ++LODIndex)
 	{
-		for (FVector3f& Vertex : RawMesh.VertexPositions)
+		FMeshDescription& MeshDescription = MeshDescriptions[LODIndex];
+		if (!Scale.Equals(FVector3f(1.0f)))
 		{
-			Vertex = Vertex * Scale;
+			TVertexAttributesRef<FVector3f> Positions = FStaticMeshAttributes(MeshDescription).GetVertexPositions();
+			for (const FVertexID VertexID : MeshDescription.Vertices().GetElementIDs())
+			{
+				Positions[VertexID] = Positions[VertexID] * Scale;
+			}
 		}
-	}
 
-	FStaticMeshSourceModel& StaticMeshSourceModel = OutStaticMesh->AddSourceModel();
-	StaticMeshSourceModel.BuildSettings = ImportOption->GetBuildSettings();
-	StaticMeshSourceModel.BuildSettings.BuildScale3D = FVector(1.0f);
-	StaticMeshSourceModel.RawMeshBulkData->SaveRawMesh(RawMesh);
+		FStaticMeshSourceModel& StaticMeshSourceModel = OutStaticMesh->AddSourceModel();
+		StaticMeshSourceModel.BuildSettings = ImportOption->GetBuildSettings();
+		StaticMeshSourceModel.BuildSettings.BuildScale3D = FVector(1.0f);
+		StaticMeshSourceModel.BuildSettings.bRecomputeNormals = false;
+		StaticMeshSourceModel.BuildSettings.bRecomputeTangents = false;
+		if (0 < LODIndex)
+		{
+			StaticMeshSourceModel.ScreenSize.Default = FMath::Clamp(ImportOption->LODScreenSizes[LODIndex - 1], 0.f, 1.f);
+		}
+		OutStaticMesh->CreateMeshDescription(OutStaticMesh->GetNumSourceModels() - 1, MoveTemp(MeshDescription));
+		OutStaticMesh->CommitMeshDescription(OutStaticMesh->GetNumSourceModels() - 1);
+	}
+	OutStaticMesh->bAutoComputeLODScreenSize = MeshDescriptions.Num() <= 1;
 	TArray<FText> Errors;
 	OutStaticMesh->Build(false, &Errors);
 	return OutStaticMesh;
 }
 
-UMaterialInterface* UVoxelFactory::CreateMaterial(UObject* InParent, FName& InName, EObjectFlags Flags, const FVox* Vox) const
+UMaterialInterface* UVoxelFactory::CreateMaterial(UObject* InParent, FName& InName, EObjectFlags Flags, const FVox* Vox, const bool bPerInstancePalette) const
 {
 	FString BasePath = FPackageName::GetLongPackagePath(InParent->GetOutermost()->GetName());
 
@@ -594,6 +1235,76 @@ UMaterialInterface* UVoxelFactory::CreateMaterial(UObject* InParent, FName& InNa
 		Expression->MaterialExpressionEditorY = -60;
 		EditorOnly->ExpressionCollection.AddExpression(Expression);
 		EditorOnly->BaseColor.Expression = Expression;
+
+		if (bPerInstancePalette)
+		{
+			// Palette texel of the instance: ((Index + 0.5) / 256, 0.5)
+			Material->bUsedWithInstancedStaticMeshes = true;
+
+			UMaterialExpressionPerInstanceCustomData* IndexExpression = NewObject<UMaterialExpressionPerInstanceCustomData>(Material);
+			IndexExpression->DataIndex = 0;
+			IndexExpression->MaterialExpressionEditorX = -1375;
+			IndexExpression->MaterialExpressionEditorY = -60;
+			EditorOnly->ExpressionCollection.AddExpression(IndexExpression);
+
+			UMaterialExpressionAdd* CenterExpression = NewObject<UMaterialExpressionAdd>(Material);
+			CenterExpression->A.Connect(0, IndexExpression);
+			CenterExpression->ConstB = 0.5f;
+			CenterExpression->MaterialExpressionEditorX = -1125;
+			CenterExpression->MaterialExpressionEditorY = -60;
+			EditorOnly->ExpressionCollection.AddExpression(CenterExpression);
+
+			UMaterialExpressionMultiply* TexelExpression = NewObject<UMaterialExpressionMultiply>(Material);
+			TexelExpression->A.Connect(0, CenterExpression);
+			TexelExpression->ConstB = 1.f / 256.f;
+			TexelExpression->MaterialExpressionEditorX = -1000;
+			TexelExpression->MaterialExpressionEditorY = -60;
+			EditorOnly->ExpressionCollection.AddExpression(TexelExpression);
+
+			UMaterialExpressionConstant* RowExpression = NewObject<UMaterialExpressionConstant>(Material);
+			RowExpression->R = 0.5f;
+			RowExpression->MaterialExpressionEditorX = -1000;
+			RowExpression->MaterialExpressionEditorY = 40;
+			EditorOnly->ExpressionCollection.AddExpression(RowExpression);
+
+			UMaterialExpressionAppendVector* CoordinateExpression = NewObject<UMaterialExpressionAppendVector>(Material);
+			CoordinateExpression->A.Connect(0, TexelExpression);
+			CoordinateExpression->B.Connect(0, RowExpression);
+			CoordinateExpression->MaterialExpressionEditorX = -825;
+			CoordinateExpression->MaterialExpressionEditorY = -60;
+			EditorOnly->ExpressionCollection.AddExpression(CoordinateExpression);
+
+			Expression->Coordinates.Connect(0, CoordinateExpression);
+
+			// Meshes without instances pass the palette texel in UV0 instead: U * 256 - 0.5
+			UMaterialExpressionTextureCoordinate* UVExpression = NewObject<UMaterialExpressionTextureCoordinate>(Material);
+			UVExpression->MaterialExpressionEditorX = -1875;
+			UVExpression->MaterialExpressionEditorY = -60;
+			EditorOnly->ExpressionCollection.AddExpression(UVExpression);
+
+			UMaterialExpressionComponentMask* UExpression = NewObject<UMaterialExpressionComponentMask>(Material);
+			UExpression->Input.Connect(0, UVExpression);
+			UExpression->R = true;
+			UExpression->MaterialExpressionEditorX = -1750;
+			UExpression->MaterialExpressionEditorY = -60;
+			EditorOnly->ExpressionCollection.AddExpression(UExpression);
+
+			UMaterialExpressionMultiply* ScaleExpression = NewObject<UMaterialExpressionMultiply>(Material);
+			ScaleExpression->A.Connect(0, UExpression);
+			ScaleExpression->ConstB = 256.f;
+			ScaleExpression->MaterialExpressionEditorX = -1625;
+			ScaleExpression->MaterialExpressionEditorY = -60;
+			EditorOnly->ExpressionCollection.AddExpression(ScaleExpression);
+
+			UMaterialExpressionAdd* DefaultExpression = NewObject<UMaterialExpressionAdd>(Material);
+			DefaultExpression->A.Connect(0, ScaleExpression);
+			DefaultExpression->ConstB = -0.5f;
+			DefaultExpression->MaterialExpressionEditorX = -1500;
+			DefaultExpression->MaterialExpressionEditorY = -60;
+			EditorOnly->ExpressionCollection.AddExpression(DefaultExpression);
+
+			IndexExpression->DefaultValue.Connect(0, DefaultExpression);
+		}
 		Material->PostEditChange();
 
 		FAssetRegistryModule::AssetCreated(Texture);
@@ -6,10 +6,14 @@
 #include <CoreMinimal.h>
 #include <EditorReimportHandler.h>
 #include <Factories/Factory.h>
-#include <RawMesh.h>
+#include <MeshDescription.h>
 #include "VoxelFactory.generated.h"
 
 struct FVox;
+struct FVoxDirectory;
+struct FVoxVolume;
+class UBlueprint;
+class USCS_Node;
 class UMaterialInterface;
 class USkeletalMesh;
 class UStaticMesh;
@@ -44,19 +48,39 @@ public:
 
 private:
 
-	UStaticMesh* CreateStaticMesh(UObject* InParent, FName InName, EObjectFlags Flags, const FVox* Vox, const uint32 ModelId) const;
+	UStaticMesh* CreateStaticMesh(UObject* InParent, FName InName, EObjectFlags Flags, const FVox* Vox, const uint32 ModelId, const FString& NameSuffix = FString()) const;
 
-	TArray<UStaticMesh*> CreateStaticMeshes(UObject* InParent, FName InName, EObjectFlags Flags, const FVox* Vox) const;
+	TArray<UObject*> CreateStaticMeshes(UObject* InParent, FName InName, EObjectFlags Flags, FVox* Vox, const FVoxDirectory* Directory = nullptr) const;
+
+	void CreateChunkedStaticMeshes(TArray<UObject*>& OutObjects, UObject* InParent, FName InName, EObjectFlags Flags, const FVox* Vox, UMaterialInterface* Material, const TArray<uint8>& Palette, const uint32 ModelId) const;
+
+	void CreateWorldStaticMeshes(TArray<UObject*>& OutObjects, UObject* InParent, FName InName, EObjectFlags Flags, const FVox* Vox, UMaterialInterface* Material, const TArray<uint8>& Palette) const;
+
+	void CreateVolumeLevels(TArray<FVoxVolume>& OutLevels, const FVox* Vox, const uint32 ModelId) const;
+
+	UBlueprint* CreateChunkBlueprint(UObject* InParent, FName InName, EObjectFlags Flags, const uint32 ModelId, const TArray<UStaticMesh*>& ChunkMeshes) const;
+
+	void RemoveStaleChunkMeshes(UObject* InParent, FName InName, const uint32 ModelId, const TArray<UStaticMesh*>& ChunkMeshes) const;
+
+	UBlueprint* CreateSceneBlueprint(UObject* InParent, FName InName, EObjectFlags Flags, const FVox* Vox, const TArray<UStaticMesh*>& ModelMeshes) const;
+
+	UBlueprint* CreateActorBlueprint(UObject* InParent, const FString& Name, EObjectFlags Flags, USCS_Node*& OutRootNode) const;
+
+	void AddStaticMaterials(UStaticMesh* StaticMesh, UObject* InParent, FName InName, const FVox* Vox, UMaterialInterface* Material, const TArray<uint8>& Palette, const uint32 ModelId) const;
 
 	UVoxel* CreateUVoxel(UObject* InParent, FName InName, EObjectFlags Flags, const FVox* Vox, const uint32 ModelId) const;
 
+	UStaticMesh* CreateVoxelMesh(FName InName, EObjectFlags Flags, UMaterialInterface* Material, const FString& MeshResourcesFolderPath, const int32 Color, const uint32 ModelId) const;
+
 	UVoxel* CreateVoxel(UObject* InParent, FName InName, EObjectFlags Flags, const FVox* Vox, UMaterialInterface* Material, const FString& MeshResourcesFolderPath, const TArray<uint8>& Palette, const uint32 ModelId) const;
 
 	TArray<UVoxel*> CreateVoxels(UObject* InParent, FName InName, EObjectFlags Flags, const FVox* Vox) const;
 
-	UStaticMesh* BuildStaticMesh(UStaticMesh* OutStaticMesh, FRawMesh& RawMesh) const;
+	UStaticMesh* BuildStaticMesh(UStaticMesh* OutStaticMesh, FMeshDescription& MeshDescription) const;
+
+	UStaticMesh* BuildStaticMesh(UStaticMesh* OutStaticMesh, TArray<FMeshDescription>& MeshDescriptions) const;
 
-	UMaterialInterface* CreateMaterial(UObject* InParent, FName& InName, EObjectFlags Flags, const FVox* Vox) const;
+	UMaterialInterface* CreateMaterial(UObject* InParent, FName& InName, EObjectFlags Flags, const FVox* Vox, const bool bPerInstancePalette = false) const;
 
 	void GenerateMaterials(UObject* InParent, FName& InName, EObjectFlags Flags, const FVox* Vox, TArray<uint8>& OutPalette) const;
 
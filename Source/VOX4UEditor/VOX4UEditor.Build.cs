@@ -33,7 +33,8 @@ public class VOX4UEditor : ModuleRules
 				"VOX4U",
 				"CoreUObject",
 				"Engine",
-				"RawMesh",
+				"MeshDescription",
+				"StaticMeshDescription",
 				"Slate",
 				"SlateCore",
 				"UnrealEd",